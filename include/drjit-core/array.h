@@ -14,9 +14,16 @@
 
 #include <drjit-core/traits.h>
 #include <drjit-core/half.h>
+#include <cstring>
+#include <tuple>
+#include <utility>
 
 NAMESPACE_BEGIN(drjit)
 
+NAMESPACE_BEGIN(expr)
+template <typename Expr> uint32_t eval(const Expr &e);
+NAMESPACE_END(expr)
+
 template <JitBackend Backend_, typename Value_> struct JitArray {
     using Value = Value_;
     using Mask = JitArray<Backend_, bool>;
@@ -83,6 +90,11 @@ template <JitBackend Backend_, typename Value_> struct JitArray {
     template <typename T, enable_if_t<drjit::detail::is_arithmetic_v<T>> = 0>
     JitArray(T val) : JitArray((Value)val) {}
 
+    /// Materialize an expression template (see \ref lazy())
+    template <typename Expr,
+              enable_if_t<std::is_same<typename Expr::Array, JitArray>::value> = 0>
+    JitArray(const Expr &e) : m_index(expr::eval(e)) { }
+
     JitArray &operator=(const JitArray &a) {
         uint32_t index = jit_var_inc_ref(a.m_index);
         jit_var_dec_ref(m_index);
@@ -97,6 +109,12 @@ template <JitBackend Backend_, typename Value_> struct JitArray {
         return *this;
     }
 
+    template <typename Expr,
+              enable_if_t<std::is_same<typename Expr::Array, JitArray>::value> = 0>
+    JitArray &operator=(const Expr &e) {
+        return operator=(JitArray(e));
+    }
+
     JitArray operator-() const {
         return steal(jit_var_neg(m_index));
     }
@@ -419,6 +437,297 @@ protected:
     uint32_t m_index = 0;
 };
 
+/*
+ * The operators of 'JitArray' immediately create a new JIT variable for every
+ * subexpression. The optional expression template layer below instead records
+ * the right hand side of an assignment as a compile-time tree, which is then
+ * materialized with a single call to \ref jit_var_op_batch() (i.e., one lock
+ * acquisition instead of one per operation, and no temporary 'JitArray'
+ * instances). The intermediate variables are still created and reference
+ * counted individually within that call. Expressions are created by wrapping
+ * an operand in \ref lazy():
+ *
+ * ```
+ * UInt32 r = lazy(a) * b + 3u;
+ * ```
+ *
+ * Expression nodes only store variable indices without holding references.
+ * They must therefore be assigned to an array within the same full-expression
+ * and should not be stored in variables (e.g., using 'auto').
+ *
+ * Some simplifications are performed at compile time while the tree is
+ * constructed: double negations cancel, and chains of integer additions or
+ * multiplications involving scalars are reassociated so that the scalars are
+ * combined before reaching the JIT compiler.
+ */
+
+NAMESPACE_BEGIN(expr)
+
+/// Base class of all expression template nodes
+struct ExprBase { };
+
+template <typename T> constexpr bool is_expr_v = std::is_base_of<ExprBase, T>::value;
+
+/// Leaf node referencing an existing array
+template <typename Array_> struct Leaf : ExprBase {
+    using Array = Array_;
+    static constexpr uint32_t Leaves = 1, Ops = 0;
+
+    uint32_t index;
+
+    Leaf(uint32_t index) : index(index) { }
+
+    uint32_t emit(uint32_t *in, uint32_t &n_in, JitBatchOp *, uint32_t &,
+                  uint32_t) const {
+        in[n_in] = index;
+        return n_in++;
+    }
+};
+
+/// Scalar constant that will be broadcast to the size of the expression
+template <typename Array_> struct Literal : ExprBase {
+    using Array = Array_;
+    using Value = typename Array::Value;
+    static constexpr uint32_t Leaves = 0, Ops = 1;
+
+    Value value;
+
+    constexpr Literal(Value value) : value(value) { }
+
+    uint32_t emit(uint32_t *, uint32_t &, JitBatchOp *ops, uint32_t &n_ops,
+                  uint32_t n_leaves) const {
+        JitBatchOp &op = ops[n_ops];
+        op.op = JitOp::Count;
+        op.type = Array::Type;
+        op.arg[0] = op.arg[1] = op.arg[2] = 0;
+        op.literal = 0;
+        memcpy(&op.literal, &value, sizeof(Value));
+        return n_leaves + n_ops++;
+    }
+};
+
+/// Operation node with one or more operands
+template <JitOp Op, typename Array_, typename... Args> struct Node : ExprBase {
+    using Array = Array_;
+    static constexpr uint32_t Leaves = (Args::Leaves + ... + 0),
+                              Ops = (Args::Ops + ... + 1);
+
+    std::tuple<Args...> args;
+
+    Node(const Args &...args) : args(args...) { }
+
+    uint32_t emit(uint32_t *in, uint32_t &n_in, JitBatchOp *ops,
+                  uint32_t &n_ops, uint32_t n_leaves) const {
+        return emit_impl(in, n_in, ops, n_ops, n_leaves,
+                         std::index_sequence_for<Args...>());
+    }
+
+private:
+    template <size_t... Is>
+    uint32_t emit_impl(uint32_t *in, uint32_t &n_in, JitBatchOp *ops,
+                       uint32_t &n_ops, uint32_t n_leaves,
+                       std::index_sequence<Is...>) const {
+        // Braced initialization guarantees left-to-right evaluation
+        uint32_t slot[3] = {
+            std::get<Is>(args).emit(in, n_in, ops, n_ops, n_leaves)...
+        };
+
+        JitBatchOp &op = ops[n_ops];
+        op.op = Op;
+        op.type = VarType::Void;
+        for (uint32_t i = 0; i < 3; ++i)
+            op.arg[i] = i < sizeof...(Args) ? slot[i] : 0;
+        op.literal = 0;
+        return n_leaves + n_ops++;
+    }
+};
+
+/// Convert an operand into an expression node compatible with 'Array'
+template <typename Array, typename T, typename = int> struct to_expr;
+
+template <typename Array, typename T>
+struct to_expr<Array, T, enable_if_t<is_expr_v<T>>> {
+    static_assert(std::is_same<typename T::Array, Array>::value,
+                  "Expression operands have incompatible types!");
+    using type = T;
+    static const T &convert(const T &value) { return value; }
+};
+
+template <typename Array, typename T>
+struct to_expr<Array, T, enable_if_t<std::is_same<T, Array>::value>> {
+    using type = Leaf<Array>;
+    static type convert(const T &value) { return type(value.index()); }
+};
+
+template <typename Array, typename T>
+struct to_expr<Array, T, enable_if_t<drjit::detail::is_arithmetic_v<T>>> {
+    using type = Literal<Array>;
+    static type convert(const T &value) {
+        return type((typename Array::Value) value);
+    }
+};
+
+template <typename Array, typename T>
+using to_expr_t = typename to_expr<Array, T>::type;
+
+/// Determine the array type of an operation, at least one operand must be an expression
+template <typename... Ts> struct expr_array;
+template <typename T, typename... Ts> struct expr_array<T, Ts...> {
+    using type = std::conditional_t<is_expr_v<T>, T, typename expr_array<Ts...>::type>;
+};
+template <> struct expr_array<> { using type = void; };
+
+template <typename... Ts>
+using expr_array_t = typename expr_array<Ts...>::type::Array;
+
+/// Create a node whose operands have type 'Array' and whose result has type 'Result'
+template <JitOp Op, typename Array, typename Result = Array, typename... Ts>
+Node<Op, Result, to_expr_t<Array, Ts>...> make_node(const Ts &...ts) {
+    return Node<Op, Result, to_expr_t<Array, Ts>...>(
+        to_expr<Array, Ts>::convert(ts)...);
+}
+
+template <typename T, typename Array = typename T::Array>
+constexpr bool is_int_expr_v =
+    drjit::detail::is_integral_v<typename Array::Value> &&
+    !std::is_same<typename Array::Value, bool>::value;
+
+/// Wrapping integer arithmetic, used to combine scalars in reassociated expressions
+template <JitOp Op, typename Value> Value fold_int(Value a, Value b) {
+    using UInt = std::make_unsigned_t<Value>;
+    return (Value) (Op == JitOp::Add ? (UInt) ((UInt) a + (UInt) b)
+                                     : (UInt) ((UInt) a * (UInt) b));
+}
+
+#define DRJIT_EXPR_BINARY_OP(op, name)                                         \
+    template <typename T1, typename T2,                                        \
+              typename Array = expr_array_t<T1, T2>>                          \
+    Node<JitOp::name, Array, to_expr_t<Array, T1>, to_expr_t<Array, T2>>      \
+    op(const T1 &a1, const T2 &a2) {                                           \
+        return make_node<JitOp::name, Array>(a1, a2);                          \
+    }
+
+#define DRJIT_EXPR_CMP_OP(op, name)                                            \
+    template <typename T1, typename T2,                                        \
+              typename Array = expr_array_t<T1, T2>>                          \
+    Node<JitOp::name, typename Array::Mask, to_expr_t<Array, T1>,              \
+         to_expr_t<Array, T2>>                                                 \
+    op(const T1 &a1, const T2 &a2) {                                           \
+        return make_node<JitOp::name, Array, typename Array::Mask>(a1, a2);    \
+    }
+
+DRJIT_EXPR_BINARY_OP(operator+, Add)
+DRJIT_EXPR_BINARY_OP(operator-, Sub)
+DRJIT_EXPR_BINARY_OP(operator*, Mul)
+DRJIT_EXPR_BINARY_OP(operator/, Div)
+DRJIT_EXPR_BINARY_OP(operator%, Mod)
+DRJIT_EXPR_BINARY_OP(operator^, Xor)
+DRJIT_EXPR_BINARY_OP(operator<<, Shl)
+DRJIT_EXPR_BINARY_OP(operator>>, Shr)
+DRJIT_EXPR_BINARY_OP(min, Min)
+DRJIT_EXPR_BINARY_OP(max, Max)
+DRJIT_EXPR_CMP_OP(operator<, Lt)
+DRJIT_EXPR_CMP_OP(operator<=, Le)
+DRJIT_EXPR_CMP_OP(operator>, Gt)
+DRJIT_EXPR_CMP_OP(operator>=, Ge)
+DRJIT_EXPR_CMP_OP(eq, Eq)
+DRJIT_EXPR_CMP_OP(neq, Neq)
+
+#undef DRJIT_EXPR_BINARY_OP
+#undef DRJIT_EXPR_CMP_OP
+
+template <typename T, enable_if_t<is_expr_v<T>> = 0>
+Node<JitOp::Neg, typename T::Array, T> operator-(const T &a) {
+    return Node<JitOp::Neg, typename T::Array, T>(a);
+}
+
+template <typename T, enable_if_t<is_expr_v<T>> = 0>
+Node<JitOp::Sqrt, typename T::Array, T> sqrt(const T &a) {
+    return Node<JitOp::Sqrt, typename T::Array, T>(a);
+}
+
+template <typename T, enable_if_t<is_expr_v<T>> = 0>
+Node<JitOp::Abs, typename T::Array, T> abs(const T &a) {
+    return Node<JitOp::Abs, typename T::Array, T>(a);
+}
+
+template <typename T1, typename T2, typename T3,
+          typename Array = expr_array_t<T1, T2, T3>>
+Node<JitOp::Fma, Array, to_expr_t<Array, T1>, to_expr_t<Array, T2>,
+     to_expr_t<Array, T3>>
+fmadd(const T1 &a1, const T2 &a2, const T3 &a3) {
+    return make_node<JitOp::Fma, Array>(a1, a2, a3);
+}
+
+template <typename T1, typename T2, typename T3,
+          typename Array = expr_array_t<T2, T3>>
+Node<JitOp::Select, Array, to_expr_t<typename Array::Mask, T1>,
+     to_expr_t<Array, T2>, to_expr_t<Array, T3>>
+select(const T1 &a1, const T2 &a2, const T3 &a3) {
+    using Mask = typename Array::Mask;
+    return Node<JitOp::Select, Array, to_expr_t<Mask, T1>,
+                to_expr_t<Array, T2>, to_expr_t<Array, T3>>(
+        to_expr<Mask, T1>::convert(a1), to_expr<Array, T2>::convert(a2),
+        to_expr<Array, T3>::convert(a3));
+}
+
+// Compile-time simplification: -(-x) == x
+template <typename Array, typename T>
+const T &operator-(const Node<JitOp::Neg, Array, T> &a) {
+    return std::get<0>(a.args);
+}
+
+// Compile-time simplification: negation of a scalar
+template <typename Array>
+Literal<Array> operator-(const Literal<Array> &a) {
+    return Literal<Array>(-a.value);
+}
+
+// Compile-time simplification: (x + c1) + c2 == x + (c1 + c2) (integers only)
+template <typename Array, typename T, typename S,
+          enable_if_t<is_int_expr_v<T> && drjit::detail::is_arithmetic_v<S>> = 0>
+Node<JitOp::Add, Array, T, Literal<Array>>
+operator+(const Node<JitOp::Add, Array, T, Literal<Array>> &a, const S &c) {
+    using Value = typename Array::Value;
+    return Node<JitOp::Add, Array, T, Literal<Array>>(
+        std::get<0>(a.args), Literal<Array>(fold_int<JitOp::Add>(
+            std::get<1>(a.args).value, (Value) c)));
+}
+
+// Compile-time simplification: (x * c1) * c2 == x * (c1 * c2) (integers only)
+template <typename Array, typename T, typename S,
+          enable_if_t<is_int_expr_v<T> && drjit::detail::is_arithmetic_v<S>> = 0>
+Node<JitOp::Mul, Array, T, Literal<Array>>
+operator*(const Node<JitOp::Mul, Array, T, Literal<Array>> &a, const S &c) {
+    using Value = typename Array::Value;
+    return Node<JitOp::Mul, Array, T, Literal<Array>>(
+        std::get<0>(a.args), Literal<Array>(fold_int<JitOp::Mul>(
+            std::get<1>(a.args).value, (Value) c)));
+}
+
+/// Materialize an expression and return a new reference to the result
+template <typename Expr> uint32_t eval(const Expr &e) {
+    using Array = typename Expr::Array;
+    constexpr uint32_t Leaves = Expr::Leaves, Ops = Expr::Ops;
+
+    if constexpr (Ops == 0) {
+        return jit_var_inc_ref(static_cast<const Leaf<Array> &>(e).index);
+    } else {
+        uint32_t in[Leaves > 0 ? Leaves : 1], n_in = 0, n_ops = 0;
+        JitBatchOp ops[Ops];
+        e.emit(in, n_in, ops, n_ops, Leaves);
+        return jit_var_op_batch(Array::Backend, in, n_in, ops, n_ops);
+    }
+}
+
+NAMESPACE_END(expr)
+
+/// Wrap an array so that arithmetic involving it produces an expression template
+template <JitBackend Backend, typename Value>
+expr::Leaf<JitArray<Backend, Value>> lazy(const JitArray<Backend, Value> &a) {
+    return expr::Leaf<JitArray<Backend, Value>>(a.index());
+}
+
 template <typename Array>
 Array empty(size_t size) {
     size_t byte_size = size * sizeof(typename Array::Value);
@@ -102,6 +102,30 @@ extern JIT_EXPORT void
 jit_init_async(uint32_t backends JIT_DEF((uint32_t) JitBackend::CUDA |
                                          (uint32_t) JitBackend::LLVM));
 
+/**
+ * \brief Enable or disable single-threaded mode
+ *
+ * Dr.Jit is thread-safe: every API call acquires a central lock that protects
+ * the internal data structures. In applications where only a single thread
+ * ever accesses Dr.Jit, this locking is pure overhead. Calling this function
+ * with <tt>value=1</tt> right after \ref jit_init() turns acquisition and
+ * release of the central locks into no-ops.
+ *
+ * The function raises an exception if another thread has already used
+ * Dr.Jit. Once enabled, a different thread that creates a Dr.Jit thread state
+ * triggers a fatal error. Debug builds additionally verify the calling thread
+ * at every lock acquisition. Release builds skip this check, so that a
+ * foreign thread using an existing thread state goes undetected and races
+ * on the internal data structures. Callbacks registered via \ref
+ * jit_enqueue_host_func() run on worker threads and must therefore not call
+ * back into Dr.Jit while this mode is active. Only the thread that enabled
+ * single-threaded mode may disable it again.
+ */
+extern JIT_EXPORT void jit_set_single_threaded(int value);
+
+/// Check whether single-threaded mode is active (see \ref jit_set_single_threaded())
+extern JIT_EXPORT int jit_single_threaded();
+
 /// Check whether the LLVM backend was successfully initialized
 extern JIT_EXPORT int jit_has_backend(JIT_ENUM JitBackend backend);
 
@@ -133,6 +157,39 @@ extern JIT_EXPORT void jit_sync_device();
 /// Wait for all computation on the *all devices* to finish
 extern JIT_EXPORT void jit_sync_all_devices();
 
+/**
+ * \brief Return a token that can be used to cancel LLVM computation issued by
+ * the calling thread
+ *
+ * The token remains valid until \ref jit_shutdown() and may be passed to
+ * \ref jit_cancel() from any thread.
+ */
+extern JIT_EXPORT void *jit_cancel_token();
+
+/**
+ * \brief Cooperatively cancel LLVM computation
+ *
+ * This function aborts kernels issued by the thread associated with \c token
+ * (see \ref jit_cancel_token()), or by the calling thread if \c token is \c
+ * nullptr. It may be called from any thread and does not block.
+ *
+ * Running kernels and other parallel operations (sorting, compression, ..)
+ * stop at the next block boundary, and pending ones skip their work entirely.
+ * The next synchronization of the affected thread that observes results
+ * (e.g., \ref jit_sync_thread() or reading a variable) raises an exception
+ * and then clears the cancellation request, even if no computation was
+ * pending. At this point, the thread can continue to use Dr.Jit.
+ *
+ * Before raising, Dr.Jit releases the memory of all kernel outputs computed
+ * since the previous synchronization. These variables enter the state 
+ef
+ * VarState::Invalid, and subsequent attempts to read them or to use them in
+ * further computation raise an exception. The contents of arrays modified by
+ * cancelled scatter operations and of outputs of other parallel operations
+ * are undefined.
+ */
+extern JIT_EXPORT void jit_cancel(void *token JIT_DEF(nullptr));
+
 // ====================================================================
 //                    CUDA/LLVM-specific functionality
 // ====================================================================
@@ -229,6 +286,32 @@ extern JIT_EXPORT void jit_llvm_set_target(const char *target_cpu,
                                            const char *target_features,
                                            uint32_t vector_width);
 
+/**
+ * \brief Generate code for a portable x86-64 ISA level instead of the host CPU
+ *
+ * Kernels compiled for the native processor (the default) embed its precise
+ * name and feature list, hence the on-disk kernel cache cannot be shared
+ * between machines with different processors. When \c portable is nonzero,
+ * the LLVM backend instead targets the most capable generic x86-64 psABI
+ * level supported by the host: <tt>x86-64-v4</tt> (AVX-512, vector width
+ * 16) or <tt>x86-64-v3</tt> (AVX2 + FMA, vector width 8). All machines at the
+ * same level then generate identical kernels and can share cache entries.
+ *
+ * When \c pregenerate is also nonzero, every kernel cache miss additionally
+ * compiles the kernel for the other level and writes it to the disk cache,
+ * so that a cache populated on one machine also serves the other kind.
+ *
+ * Passing <tt>portable=3</tt> selects <tt>x86-64-v3</tt> even on hosts that
+ * support the higher level, which is mainly useful for testing the cache
+ * entries of the other level. Passing <tt>portable=0</tt> restores the host
+ * target. This function is a no-op (with a warning) on non-x86 platforms.
+ */
+extern JIT_EXPORT void jit_llvm_set_portable(int portable,
+                                             int pregenerate JIT_DEF(0));
+
+/// Return the targeted x86-64 ISA level (3 or 4), or 0 for the host CPU
+extern JIT_EXPORT uint32_t jit_llvm_isa_level();
+
 /// Get the CPU that is currently targeted by the LLVM backend
 extern JIT_EXPORT const char *jit_llvm_target_cpu();
 
@@ -253,6 +336,63 @@ extern JIT_EXPORT void jit_llvm_set_block_size(uint32_t size);
 /// Return the number of SIMD packets that form one parallel work item
 extern JIT_EXPORT uint32_t jit_llvm_block_size();
 
+#if defined(__cplusplus)
+/// Scheduling priority of LLVM kernels launched by a thread
+enum class JitPriority : uint32_t {
+    /// Kernels are processed by the shared thread pool (default)
+    Normal,
+
+    /// Kernels run on a dedicated thread pool, and other work yields to them
+    High
+};
+#else
+enum JitPriority {
+    JitPriorityNormal,
+    JitPriorityHigh
+};
+#endif
+
+/**
+ * \brief Set the scheduling priority of LLVM kernels launched by the calling
+ * thread
+ *
+ * By default, all threads submit their kernels into one shared dependency
+ * chain processed by the same thread pool. Latency-critical work (e.g., an
+ * interactive preview) then queues behind the work units of unrelated batch
+ * computation running in the same process.
+ *
+ * With <tt>JitPriority::High</tt>, the calling thread's kernels instead form
+ * a separate dependency chain that is processed by a dedicated, smaller
+ * thread pool (see \ref jit_llvm_set_priority_thread_count()). Work of
+ * normal priority does not start before high-priority work that was
+ * submitted earlier has finished. Furthermore, work units of normal-priority
+ * kernels that would start while high-priority work units are running are
+ * skipped and re-queued behind the kernel, so that they release their
+ * worker thread. This effectively preempts them at work-unit granularity.
+ * High-priority kernels that still wait for earlier work of their own thread
+ * do not hold back other threads.
+ *
+ * Threads with different priorities do not synchronize with each other. Data
+ * produced by one thread must therefore be synchronized via \ref
+ * jit_sync_thread() by that thread before another thread accesses it.
+ * Changing the priority synchronizes the calling thread.
+ */
+extern JIT_EXPORT void jit_llvm_set_priority(JIT_ENUM JitPriority priority);
+
+/// Return the scheduling priority of the calling thread's LLVM kernels
+extern JIT_EXPORT JIT_ENUM JitPriority jit_llvm_priority();
+
+/**
+ * \brief Specify the number of threads that process high-priority kernels
+ *
+ * The default value \c 0 selects a quarter of the size of the default pool
+ * (at least one thread). See \ref jit_llvm_set_priority().
+ */
+extern JIT_EXPORT void jit_llvm_set_priority_thread_count(uint32_t size);
+
+/// Return the number of threads that process high-priority kernels
+extern JIT_EXPORT uint32_t jit_llvm_priority_thread_count();
+
 // ====================================================================
 //                        Logging infrastructure
 // ====================================================================
@@ -670,6 +810,65 @@ enum JitOp {
  */
 extern JIT_EXPORT uint32_t jit_var_op(JIT_ENUM JitOp op, const uint32_t *dep);
 
+/// Describes a single entry of the operation list consumed by \ref jit_var_op_batch()
+struct JitBatchOp {
+    /// Operation to be performed, or \c JitOp::Count to create a literal
+    JitOp op;
+
+    /// Type of the literal constant (only used when <tt>op == JitOp::Count</tt>)
+    VarType type;
+
+    /// Operand slots (see \ref jit_var_op_batch() for their interpretation)
+    uint32_t arg[3];
+
+    /// Literal value reinterpreted as u64 (only used when <tt>op == JitOp::Count</tt>)
+    uint64_t literal;
+};
+
+/**
+ * \brief Perform a sequence of arithmetic operations in a single step
+ *
+ * Building an expression through repeated calls to \ref jit_var_op() and
+ * friends acquires the central lock once per operation. This function instead
+ * materializes an entire expression graph while holding the lock only once.
+ *
+ * Note that the reference counting work is unchanged: every intermediate
+ * result is still created as a separate variable, which references its
+ * operands and is itself referenced by its consumers. Its own reference is
+ * dropped before the function returns.
+ *
+ * Operands are specified using *slots*: indices <tt>0 .. n_in - 1</tt> refer
+ * to the input variables <tt>in[0] .. in[n_in - 1]</tt>, and index <tt>n_in +
+ * i</tt> refers to the result of <tt>ops[i]</tt>. An operation may only
+ * reference results of preceding operations. Unused entries of \ref
+ * JitBatchOp::arg are ignored. Entries with <tt>op == JitOp::Count</tt>
+ * create a scalar literal of type \ref JitBatchOp::type on the given
+ * backend.
+ *
+ * The function returns a new reference to the result of the final operation
+ * (<tt>ops[n_ops - 1]</tt>). All intermediate results are released once the
+ * expression has been constructed. The following are equivalent:
+ *
+ * ```
+ * // Separate calls
+ * uint32_t t = jit_var_mul(a, b);
+ * uint32_t r = jit_var_add(t, c);
+ * jit_var_dec_ref(t);
+ *
+ * // Batched version
+ * uint32_t in[3] = { a, b, c };
+ * JitBatchOp ops[2] = {
+ *     { JitOp::Mul, VarType::Void, { 0, 1, 0 }, 0 }, // slot 3 = a * b
+ *     { JitOp::Add, VarType::Void, { 3, 2, 0 }, 0 }  // slot 4 = slot 3 + c
+ * };
+ * uint32_t r = jit_var_op_batch(backend, in, 3, ops, 2);
+ * ```
+ */
+extern JIT_EXPORT uint32_t jit_var_op_batch(JIT_ENUM JitBackend backend,
+                                            const uint32_t *in, uint32_t n_in,
+                                            const struct JitBatchOp *ops,
+                                            uint32_t n_ops);
+
 /// Compute `-a0` and return a variable representing the result
 extern JIT_EXPORT uint32_t jit_var_neg(uint32_t a0);
 
@@ -775,7 +974,17 @@ extern JIT_EXPORT uint32_t jit_var_rcp(uint32_t a0);
 /// Approximate `1 / sqrt(a0)` and return a variable representing the result
 extern JIT_EXPORT uint32_t jit_var_rsqrt(uint32_t a0);
 
-/// Approximate `sin(a0)` and return a variable representing the result
+/**
+ * \brief Approximate `sin(a0)` and return a variable representing the result
+ *
+ * The CUDA backend maps this and the following three operations onto the
+ * hardware's multi-function unit. The LLVM backend calls vectorized polynomial
+ * kernels, whose faster and less accurate variant is used when
+ * <tt>JitFlag::FastMath</tt> is set (which is the default). The accurate
+ * variant stays within a few ULP, while the fast one has a relative error of
+ * up to ~2e-6 (single precision) or ~6e-15 (double precision). Sin/Cos handle
+ * arguments over the full floating point range.
+ */
 extern JIT_EXPORT uint32_t jit_var_sin_intrinsic(uint32_t a0);
 
 /// Approximate `cos(a0)` and return a variable representing the result
@@ -787,6 +996,28 @@ extern JIT_EXPORT uint32_t jit_var_exp2_intrinsic(uint32_t a0);
 /// Approximate `log2(a0)` and return a variable representing the result
 extern JIT_EXPORT uint32_t jit_var_log2_intrinsic(uint32_t a0);
 
+/**
+ * \brief Generate random numbers using a counter-based generator
+ *
+ * This function evaluates the Philox2x32-10 bijection on the counter pair
+ * <tt>(counter, stream)</tt> using \c seed as key. All three arguments must
+ * be unsigned 32-bit arrays with compatible sizes. A typical choice for
+ * \c counter is the lane index produced by \ref jit_var_counter(), while
+ * \c stream enumerates separate sample dimensions or loop iterations.
+ *
+ * The result is a pure function of the inputs, hence generating random
+ * numbers does not involve any state that must be loaded from or written to
+ * memory, and the output does not depend on how kernels are split. The
+ * parameter \c vt selects the output: <tt>VarType::UInt32</tt> (first
+ * word), <tt>VarType::UInt64</tt> (both words), and <tt>VarType::Float32</tt>
+ * or <tt>VarType::Float64</tt> (uniformly distributed on the interval
+ * <tt>[0, 1)</tt>). This operation is currently only supported by the LLVM
+ * backend.
+ */
+extern JIT_EXPORT uint32_t jit_var_philox(JIT_ENUM VarType vt,
+                                          uint32_t counter, uint32_t stream,
+                                          uint32_t seed);
+
 /// Return a variable indicating valid lanes within a function call
 extern JIT_EXPORT uint32_t jit_var_call_mask(JitBackend backend);
 
@@ -845,6 +1076,25 @@ extern JIT_EXPORT void jit_var_gather_packet(size_t n, uint32_t source,
                                              uint32_t index, uint32_t mask,
                                              uint32_t *out);
 
+/**
+ * \brief Locate insertion points within a sorted array
+ *
+ * For each entry of \c value, this function returns the index of the first
+ * element of the evaluated and sorted array \c source that is <em>not
+ * less</em> than it (when <tt>right == 0</tt>, analogous to
+ * <tt>std::lower_bound()</tt>) or that is <em>greater</em> than it (when
+ * <tt>right != 0</tt>, analogous to <tt>std::upper_bound()</tt>). The result
+ * is an unsigned 32-bit array with the size of \c value.
+ *
+ * Both variables must have the same (32/64-bit integer or floating point)
+ * type. The search is lowered into a branch-free sequence of gathers that
+ * performs the same number of steps in every SIMD lane, which is
+ * considerably faster than a symbolic loop. This operation is currently
+ * only supported by the LLVM backend.
+ */
+extern JIT_EXPORT uint32_t jit_var_searchsorted(uint32_t source, uint32_t value,
+                                                int right JIT_DEF(0));
+
 /// Reverse the order of a JIT array
 extern JIT_EXPORT uint32_t jit_var_reverse(uint32_t index);
 
@@ -925,7 +1175,14 @@ enum class ReduceMode : uint32_t {
     /// because we then know that the forward-mode derivative does not depend
     /// on any prior derivative values associated with that array, as all
     /// current entries will be overwritten.
-    Permute
+    Permute,
+
+    /// Like 'Local', but combine scatters going to the same address within
+    /// the packet using conflict detection (AVX512CD) and a logarithmic number
+    /// of permutation steps, followed by one atomic operation per unique
+    /// address. Other LLVM targets and the CUDA backend interpret this flag
+    /// as 'Local'.
+    Conflict
 };
 #else
 enum ReduceOp {
@@ -1181,7 +1438,8 @@ extern JIT_EXPORT int jit_var_is_dirty(uint32_t index);
 
 // Enumeration describing possible evaluation states of a Dr.Jit variable
 enum class VarState : uint32_t {
-    /// The variable has length 0 and effectively does not exist
+    /// The variable has length 0 and effectively does not exist, or it was
+    /// computed by a cancelled kernel and has been released (see jit_cancel())
     Invalid,
 
     /// An undefined memory region. Does not (yet) consume device memory.
@@ -1360,6 +1618,9 @@ extern JIT_EXPORT uint32_t jit_var_registry_attr(JIT_ENUM JitBackend backend,
  * Returns \c 1 if anything was scheduled, and \c 0 otherwise. In the former
  * case, the caller should eventually invoke \ref jit_eval() to complete the
  * variable evaluation process.
+ *
+ * When \ref JitFlag::EvalCostModel is set, \ref jit_eval() may leave cheap
+ * expressions scheduled by this function unevaluated.
  */
 extern JIT_EXPORT int jit_var_schedule(uint32_t index);
 
@@ -1566,6 +1827,19 @@ enum class JitFlag : uint32_t {
     /// Set to \c true when Dr.Jit is recording a frozen function
     FreezingScope = 1 << 21,
 
+    /* Use a cost model to decide which intermediate values jit_eval() should
+       store to memory. Cheap expressions scheduled via jit_var_schedule() are
+       then recomputed by later kernels instead of being stored, while
+       expensive unevaluated intermediates that remain referenced elsewhere
+       are stored to avoid recomputing them later. */
+    EvalCostModel = 1 << 22,
+
+    /* When evaluating conditionals (i.e., when SymbolicConditionals is not
+       set), run rarely taken branches only on the compacted subset of their
+       active lanes. This is only consulted by \ref jit_var_cond_compact(),
+       which callers must opt into, and is therefore disabled by default. */
+    CompactConditionals = 1 << 23,
+
     /// Default flags
     Default = (uint32_t) ConstantPropagation | (uint32_t) ValueNumbering |
               (uint32_t) FastMath | (uint32_t) SymbolicLoops |
@@ -1607,6 +1881,8 @@ enum JitFlag {
     JitFlagSymbolic = 1 << 19
     KernelFreezing = 1 << 20,
     FreezingScope = 1 << 21,
+    JitFlagEvalCostModel = 1 << 22,
+    JitFlagCompactConditionals = 1 << 23,
 };
 #endif
 
@@ -1816,6 +2092,49 @@ extern JIT_EXPORT uint32_t jit_var_cond_append(uint32_t index,
  */
 extern JIT_EXPORT void jit_var_cond_end(uint32_t index, uint32_t *rv_out);
 
+/**
+ * \brief Determine how each branch of an evaluated conditional should run
+ *
+ * When conditionals are not captured symbolically, both branches normally run
+ * as separate kernels over the full wavefront with masked operations. This is
+ * wasteful when one branch is only taken by a small number of lanes,
+ * especially when that branch is expensive.
+ *
+ * This function evaluates the branch masks and determines the number of
+ * lanes taking each branch. It then writes one of the following to \c
+ * index_t and \c index_f:
+ *
+ * - ``0``: no lane takes the branch, and it can be skipped altogether.
+ *
+ * - A boolean array (the branch mask, broadcast to the size of the
+ *   conditional): the branch should run at full width under this mask.
+ *
+ * - An unsigned 32-bit array: the compacted indices of the lanes taking the
+ *   branch (see \ref jit_var_compress()). The caller should gather the
+ *   branch inputs using these indices, run the branch on this subset, and
+ *   scatter its outputs back into the full-width result.
+ *
+ * Compaction is used when \ref JitFlag::CompactConditionals is set, and
+ * when at most a quarter of the lanes take the branch. The masks must have
+ * compatible sizes, and scalar masks are broadcast. A zero-valued mask index
+ * denotes a branch that no lane takes. The caller has the responsibility of
+ * reducing the reference count of the returned variables.
+ *
+ * \param name
+ *    A descriptive name
+ *
+ * \param cond_t
+ *    Variable index of a boolean array specifying whether the 'true' branch
+ *    should be executed. Set this to (condition & mask)
+ *
+ * \param cond_f
+ *    Variable index of a boolean array specifying whether the 'false' branch
+ *    should be executed. Set this to (!condition & mask)
+ */
+extern JIT_EXPORT void jit_var_cond_compact(const char *name, uint32_t cond_t,
+                                            uint32_t cond_f, uint32_t *index_t,
+                                            uint32_t *index_f);
+
 /**
  * \brief Wrap an input variable of a virtual function call before recording
  * computation
@@ -1937,6 +2256,32 @@ extern JIT_EXPORT uint32_t jit_var_mask_apply(uint32_t index, uint32_t size);
 /// Compress a sparse boolean array into an index array of the active indices
 extern JIT_EXPORT uint32_t jit_var_compress(uint32_t index);
 
+/**
+ * \brief Sort the array \c keys, and reorder \c values in the same way
+ *
+ * This operation evaluates the inputs and invokes \ref jit_sort_pairs() (or
+ * \ref jit_sort() when \c values is zero). The sorted keys and values are
+ * returned as new variables via \c keys_out and \c values_out.
+ */
+extern JIT_EXPORT void jit_var_sort(uint32_t keys, uint32_t values,
+                                    uint32_t *keys_out,
+                                    uint32_t *values_out JIT_DEF(nullptr));
+
+/**
+ * \brief Compute a dense histogram of the 32-bit integer array \c values
+ *
+ * This operation evaluates the inputs and invokes \ref jit_histogram(). It
+ * returns a new array of size \c bin_count. When \c weights is zero, the
+ * result is an <tt>UInt32</tt> array counting the occurrences of each bin
+ * index. Otherwise, it accumulates the entries of \c weights (which must have
+ * the same size as \c values), and the result has the type of \c weights.
+ * Entries of \c values outside of the range <tt>[0, bin_count)</tt> are
+ * ignored.
+ */
+extern JIT_EXPORT uint32_t jit_var_histogram(uint32_t values,
+                                             uint32_t bin_count,
+                                             uint32_t weights JIT_DEF(0));
+
 // ====================================================================
 //                          Horizontal reductions
 // ====================================================================
@@ -2119,6 +2464,58 @@ extern JIT_EXPORT uint32_t jit_mkperm(JIT_ENUM JitBackend backend, const uint32_
                                       uint32_t size, uint32_t bucket_count,
                                       uint32_t *perm, uint32_t *offsets);
 
+/**
+ * \brief Stable sort of an array of keys
+ *
+ * Sorts the array \c keys_in of size \c size in increasing order and writes
+ * the result to \c keys_out. The two may refer to the same memory region.
+ * Supported key types are <tt>VarType::UInt32</tt>, <tt>Int32</tt>,
+ * <tt>Float32</tt>, <tt>UInt64</tt>, <tt>Int64</tt>, and <tt>Float64</tt>.
+ *
+ * The LLVM backend implements this as a parallel LSD radix sort that
+ * processes 8 bits per pass and skips passes where all keys share the same
+ * digit. The operation is asynchronous. It is not supported by the CUDA
+ * backend at the moment.
+ */
+extern JIT_EXPORT void jit_sort(JIT_ENUM JitBackend backend,
+                                JIT_ENUM VarType vt, const void *keys_in,
+                                void *keys_out, uint32_t size);
+
+/**
+ * \brief Stable sort of an array of keys along with 32-bit values
+ *
+ * Analogous to \ref jit_sort(), but additionally reorders the array
+ * \c values_in in the same way and writes the result to \c values_out.
+ */
+extern JIT_EXPORT void jit_sort_pairs(JIT_ENUM JitBackend backend,
+                                      JIT_ENUM VarType vt, const void *keys_in,
+                                      const uint32_t *values_in,
+                                      void *keys_out, uint32_t *values_out,
+                                      uint32_t size);
+
+/**
+ * \brief Compute a dense histogram of a 32-bit integer array
+ *
+ * Accumulates <tt>weights[i]</tt> (or 1 when \c weights is \c nullptr) into
+ * <tt>out[values[i]]</tt> for all <tt>i < size</tt>, skipping entries with
+ * <tt>values[i] >= bin_count</tt>. The output array of size \c bin_count is
+ * overwritten. \c vt specifies the type of \c weights and \c out, and must
+ * be <tt>VarType::UInt32</tt> when no weights are given. Supported types are
+ * 32/64-bit integers and single/double precision floating point values.
+ *
+ * Instead of atomic updates to a shared target, the LLVM backend lets each
+ * worker accumulate into a private copy of the bins. These copies are padded
+ * to a multiple of the cache line size and merged using a parallel tree
+ * reduction, so throughput does not depend on how many entries go to the
+ * same bin. The operation is asynchronous. It is not supported by the CUDA
+ * backend at the moment.
+ */
+extern JIT_EXPORT void jit_histogram(JIT_ENUM JitBackend backend,
+                                     JIT_ENUM VarType vt,
+                                     const uint32_t *values,
+                                     const void *weights, uint32_t size,
+                                     uint32_t bin_count, void *out);
+
 /// Helper data structure used to initialize the data block consumed by a vcall
 struct AggregationEntry {
     int32_t size;
@@ -2430,6 +2827,44 @@ extern JIT_EXPORT void jit_enqueue_host_func(JitBackend backend,
 extern JIT_EXPORT void jit_llvm_set_expand_threshold(size_t size);
 extern JIT_EXPORT size_t jit_llvm_expand_threshold() JIT_NOEXCEPT;
 
+/**
+ * \brief Set the array size (in bytes) above which LLVM kernels use
+ * non-temporal memory accesses
+ *
+ * Non-temporal loads and stores bypass the cache hierarchy, which avoids
+ * evicting useful data when streaming through large arrays. For arrays that
+ * fit into the last-level cache, this instead forces a needless round trip
+ * to main memory when a subsequent kernel consumes the result. Accesses to
+ * smaller arrays, and to values shared by the parts of a split kernel (see
+ * \ref jit_set_kernel_split_threshold()), therefore use ordinary temporal
+ * accesses. Set to "0" to always use non-temporal accesses. The default is
+ * 33554432 (32 MiB), which should roughly match the last-level cache size of
+ * the target machine.
+ *
+ * The choice is made when the kernel is generated and is part of its IR and
+ * hash. A computation that runs on arrays both below and above the threshold
+ * is therefore compiled (and cached) twice, once for each variant.
+ */
+extern JIT_EXPORT void jit_llvm_set_nontemporal_threshold(size_t size);
+extern JIT_EXPORT size_t jit_llvm_nontemporal_threshold() JIT_NOEXCEPT;
+
+/**
+ * \brief Set the number of operations above which a kernel is automatically
+ * split into several smaller kernels
+ *
+ * Very large kernels compile slowly and tend to spill registers. When the
+ * operations scheduled into a single kernel exceed this threshold,
+ * ``jit_eval()`` partitions them at points where few intermediate values
+ * cross from one part to the next. These values are then stored to
+ * temporary memory and reloaded by the subsequent kernel.
+ *
+ * Kernels containing symbolic loops, conditionals, calls, or variable arrays
+ * are never split. Set to "0" to disable splitting entirely. The default is
+ * 262144 (256K operations).
+ */
+extern JIT_EXPORT void jit_set_kernel_split_threshold(uint32_t size);
+extern JIT_EXPORT uint32_t jit_kernel_split_threshold() JIT_NOEXCEPT;
+
 /// Return the identity element of a particular type of reduction
 extern JIT_EXPORT uint64_t jit_reduce_identity(VarType vt, ReduceOp op);
 
@@ -64,6 +64,16 @@ void jit_init_async(uint32_t backends) {
         sync->cv.wait(guard);
 }
 
+void jit_set_single_threaded(int value) {
+    // Use the underlying lock directly, since the elision mode may change
+    lock_guard guard(state.lock.lock);
+    jitc_set_single_threaded(value != 0);
+}
+
+int jit_single_threaded() {
+    return (int) lock_elide.load(std::memory_order_relaxed);
+}
+
 int jit_has_backend(JitBackend backend) {
     lock_guard guard(state.lock);
 
@@ -307,13 +317,45 @@ uint32_t jit_llvm_thread_count() {
     return pool_size(nullptr);
 }
 
+void jit_llvm_set_priority(JitPriority priority) {
+    lock_guard guard(state.lock);
+    jitc_llvm_set_priority(priority);
+}
+
+JitPriority jit_llvm_priority() {
+    lock_guard guard(state.lock);
+    return thread_state(JitBackend::LLVM)->priority;
+}
+
+void jit_llvm_set_priority_thread_count(uint32_t size) {
+    lock_guard guard(state.lock);
+    jitc_llvm_set_priority_thread_count(size);
+}
+
+uint32_t jit_llvm_priority_thread_count() {
+    lock_guard guard(state.lock);
+    return jitc_llvm_priority_thread_count();
+}
+
 void jit_llvm_set_target(const char *target_cpu,
                          const char *target_features,
                          uint32_t vector_width) {
     lock_guard guard(state.lock);
+    lock_guard guard_2(state.compile_lock);
     jitc_llvm_set_target(target_cpu, target_features, vector_width);
 }
 
+void jit_llvm_set_portable(int portable, int pregenerate) {
+    lock_guard guard(state.lock);
+    lock_guard guard_2(state.compile_lock);
+    jitc_llvm_set_portable((uint32_t) portable, pregenerate != 0);
+}
+
+uint32_t jit_llvm_isa_level() {
+    lock_guard guard(state.lock);
+    return jitc_llvm_isa_level;
+}
+
 const char *jit_llvm_target_cpu() {
     lock_guard guard(state.lock);
     return jitc_llvm_target_cpu;
@@ -341,16 +383,33 @@ uint32_t jit_llvm_vector_width() {
 void jit_sync_thread() {
     lock_guard guard(state.lock);
     jitc_sync_thread();
+    jitc_check_cancelled();
+}
+
+void *jit_cancel_token() {
+    lock_guard guard(state.lock);
+    return (void *) thread_state(JitBackend::LLVM)->cancelled;
+}
+
+void jit_cancel(void *token) {
+    if (!token) {
+        lock_guard guard(state.lock);
+        token = (void *) thread_state(JitBackend::LLVM)->cancelled;
+    }
+    // Only touches an atomic flag, the central lock is not needed
+    ((std::atomic<bool> *) token)->store(true, std::memory_order_relaxed);
 }
 
 void jit_sync_device() {
     lock_guard guard(state.lock);
     jitc_sync_device();
+    jitc_check_cancelled();
 }
 
 void jit_sync_all_devices() {
     lock_guard guard(state.lock);
     jitc_sync_all_devices();
+    jitc_check_cancelled();
 }
 
 void jit_flush_kernel_cache() {
@@ -526,6 +585,13 @@ uint32_t jit_var_op(JitOp op, const uint32_t *dep) {
     return jitc_var_op(op, dep);
 }
 
+uint32_t jit_var_op_batch(JitBackend backend, const uint32_t *in,
+                          uint32_t n_in, const JitBatchOp *ops,
+                          uint32_t n_ops) {
+    lock_guard guard(state.lock);
+    return jitc_var_op_batch(backend, in, n_in, ops, n_ops);
+}
+
 uint32_t jit_var_gather(uint32_t source, uint32_t index, uint32_t mask) {
     lock_guard guard(state.lock);
     return jitc_var_gather(source, index, mask);
@@ -536,6 +602,11 @@ void jit_var_gather_packet(size_t n, uint32_t source, uint32_t index, uint32_t m
     jitc_var_gather_packet(n, source, index, mask, out);
 }
 
+uint32_t jit_var_searchsorted(uint32_t source, uint32_t value, int right) {
+    lock_guard guard(state.lock);
+    return jitc_var_searchsorted(source, value, right);
+}
+
 uint32_t jit_var_scatter(uint32_t target, uint32_t value,
                          uint32_t index, uint32_t mask,
                          ReduceOp op, ReduceMode mode) {
@@ -885,7 +956,7 @@ int jit_var_schedule(uint32_t index) {
     if (index == 0)
         return 0;
     lock_guard guard(state.lock);
-    return jitc_var_schedule(index);
+    return jitc_var_schedule(index, true);
 }
 
 uint32_t jit_var_schedule_force(uint32_t index, int *rv) {
@@ -955,6 +1026,26 @@ uint32_t jit_mkperm(JitBackend backend, const uint32_t *values, uint32_t size,
     return jitc_mkperm(backend, values, size, bucket_count, perm, offsets);
 }
 
+void jit_sort(JitBackend backend, VarType vt, const void *keys_in,
+              void *keys_out, uint32_t size) {
+    lock_guard guard(state.lock);
+    jitc_sort(backend, vt, size, keys_in, nullptr, keys_out, nullptr);
+}
+
+void jit_sort_pairs(JitBackend backend, VarType vt, const void *keys_in,
+                    const uint32_t *values_in, void *keys_out,
+                    uint32_t *values_out, uint32_t size) {
+    lock_guard guard(state.lock);
+    jitc_sort(backend, vt, size, keys_in, values_in, keys_out, values_out);
+}
+
+void jit_histogram(JitBackend backend, VarType vt, const uint32_t *values,
+                   const void *weights, uint32_t size, uint32_t bin_count,
+                   void *out) {
+    lock_guard guard(state.lock);
+    jitc_histogram(backend, vt, size, values, weights, bin_count, out);
+}
+
 uint32_t jit_registry_put(const char *variant, const char *domain, void *ptr) {
     lock_guard guard(state.lock);
     return jitc_registry_put(variant, domain, ptr);
@@ -1322,6 +1413,12 @@ uint32_t jit_var_log2_intrinsic(uint32_t a0) {
     return jitc_var_log2_intrinsic(a0);
 }
 
+uint32_t jit_var_philox(VarType vt, uint32_t counter, uint32_t stream,
+                        uint32_t seed) {
+    lock_guard guard(state.lock);
+    return jitc_var_philox(vt, counter, stream, seed);
+}
+
 uint32_t jit_var_cast(uint32_t index, VarType target_type,
                       int reinterpret) {
     lock_guard guard(state.lock);
@@ -1397,6 +1494,12 @@ void jit_var_cond_end(uint32_t index, uint32_t *rv_out) {
     jitc_var_cond_end(index, rv_out);
 }
 
+void jit_var_cond_compact(const char *name, uint32_t cond_t, uint32_t cond_f,
+                          uint32_t *index_t, uint32_t *index_f) {
+    lock_guard guard(state.lock);
+    jitc_var_cond_compact(name, cond_t, cond_f, index_t, index_f);
+}
+
 void jit_set_source_location(const char *fname, size_t lineno) noexcept {
     jitc_set_source_location(fname, lineno);
 }
@@ -1423,6 +1526,18 @@ uint32_t jit_var_compress(uint32_t index) {
     return jitc_var_compress(index);
 }
 
+void jit_var_sort(uint32_t keys, uint32_t values, uint32_t *keys_out,
+                  uint32_t *values_out) {
+    lock_guard guard(state.lock);
+    jitc_var_sort(keys, values, keys_out, values_out);
+}
+
+uint32_t jit_var_histogram(uint32_t values, uint32_t bin_count,
+                           uint32_t weights) {
+    lock_guard guard(state.lock);
+    return jitc_var_histogram(values, bin_count, weights);
+}
+
 // Shrink a variable after it has been created
 uint32_t jit_var_shrink(uint32_t index, size_t size) {
     lock_guard guard(state.lock);
@@ -1451,6 +1566,27 @@ size_t jit_llvm_expand_threshold() noexcept {
     return llvm_expand_threshold;
 }
 
+// Declared in llvm.h
+size_t llvm_nontemporal_threshold = 32 * 1024 * 1024; // 32 MiB
+
+void jit_llvm_set_nontemporal_threshold(size_t size) {
+    llvm_nontemporal_threshold = size;
+}
+
+size_t jit_llvm_nontemporal_threshold() noexcept {
+    return llvm_nontemporal_threshold;
+}
+
+uint32_t kernel_split_threshold = 256 * 1024; // 256K operations
+
+void jit_set_kernel_split_threshold(uint32_t size) {
+    kernel_split_threshold = size;
+}
+
+uint32_t jit_kernel_split_threshold() noexcept {
+    return kernel_split_threshold;
+}
+
 uint64_t jit_reduce_identity(VarType vt, ReduceOp op) {
     lock_guard guard(state.lock);
     return jitc_reduce_identity(vt, op);
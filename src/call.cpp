@@ -676,11 +676,11 @@ void jitc_call_upload(ThreadState *ts) {
             jitc_free(data);
         } else {
             Task *new_task = task_submit_dep(
-                nullptr, &jitc_task, 1, 1,
+                ts->pool, ts->task, 1, 1,
                 [](uint32_t, void *payload) { free(*((void **) payload)); },
                 &data, sizeof(void *), nullptr, 1);
-            task_release(jitc_task);
-            jitc_task = new_task;
+            task_release(*ts->task);
+            *ts->task = new_task;
         }
     }
 
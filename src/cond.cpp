@@ -222,3 +222,72 @@ void jitc_var_cond_end(uint32_t index, uint32_t *rv_out) {
         variable_count_actual == 1 ? "" : "s", storage, storage_actual,
         side_effect_count, side_effect_count == 1 ? "" : "s");
 }
+
+void jitc_var_cond_compact(const char *name, uint32_t cond_t, uint32_t cond_f,
+                           uint32_t *index_t, uint32_t *index_f) {
+    uint32_t cond_in[2] = { cond_t, cond_f };
+    uint32_t *index_out[2] = { index_t, index_f };
+    uint32_t size = 0, count[2] = { 0, 0 };
+    JitBackend backend = JitBackend::None;
+
+    // Determine the size of the conditional, zero-valued masks are skipped
+    for (int i = 0; i < 2; ++i) {
+        *index_out[i] = 0;
+        if (!cond_in[i])
+            continue;
+
+        const Variable *v = jitc_var(cond_in[i]);
+        if ((VarType) v->type != VarType::Bool)
+            jitc_raise("jit_var_cond_compact(): the branch masks must be "
+                       "boolean arrays!");
+        if (size != 0 && v->size != size && v->size != 1 && size != 1)
+            jitc_raise("jit_var_cond_compact(): the branch masks have "
+                       "incompatible sizes (%u and %u)!", size, v->size);
+
+        size = std::max(size, v->size);
+        backend = (JitBackend) v->backend;
+    }
+
+    if (backend == JitBackend::None)
+        return;
+
+    /* Broadcast scalar masks, which would otherwise compress to a single
+       index. Then evaluate both masks using a single kernel */
+    Ref cond[2];
+    int scheduled = 0;
+    for (int i = 0; i < 2; ++i) {
+        if (!cond_in[i])
+            continue;
+        cond[i] = steal(jitc_var_resize(cond_in[i], size));
+        scheduled += jitc_var_schedule(cond[i]);
+    }
+
+    if (scheduled > 0)
+        jitc_eval(thread_state(backend));
+
+    bool compact = jitc_flags() & (uint32_t) JitFlag::CompactConditionals;
+
+    for (int i = 0; i < 2; ++i) {
+        Ref indices = steal(jitc_var_compress(cond[i]));
+        count[i] = indices ? jitc_var(indices)->size : 0;
+
+        if (count[i] == 0)
+            continue;
+        else if (compact && count[i] * 4 <= size)
+            *index_out[i] = indices.release();
+        else
+            *index_out[i] = cond[i].release();
+    }
+
+    auto mode_name = [](uint32_t index) {
+        return !index ? "skipped"
+                      : (jitc_var(index)->type == (uint32_t) VarType::Bool
+                             ? "masked" : "compacted");
+    };
+
+    jitc_log(InfoSym,
+             "jit_var_cond_compact(\"%s\"): true branch: %u/%u lanes (%s), "
+             "false branch: %u/%u lanes (%s).",
+             name, count[0], size, mode_name(*index_t), count[1], size,
+             mode_name(*index_f));
+}
@@ -25,3 +25,6 @@ extern uint32_t jitc_var_cond_start(const char *name, bool symbolic,
 extern uint32_t jitc_var_cond_append(uint32_t index, const uint32_t *rv,
                                      size_t count);
 extern void jitc_var_cond_end(uint32_t index, uint32_t *rv_out);
+extern void jitc_var_cond_compact(const char *name, uint32_t cond_t,
+                                  uint32_t cond_f, uint32_t *index_t,
+                                  uint32_t *index_f);
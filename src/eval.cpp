@@ -25,8 +25,8 @@
 // ====================================================================
 //  The following data structures are temporarily used during program
 //  generation. They are declared as global variables to enable memory
-//  reuse across jitc_eval() calls. Access to them is protected by the
-//  central Dr.Jit mutex.
+//  reuse across jitc_eval() calls. Access to them is protected by
+//  'state.eval_lock' (see jitc_eval()).
 // ====================================================================
 
 /// Ordered list of variables that should be computed
@@ -100,6 +100,21 @@ static std::vector<uint32_t> eval_callbacks;
 /// Temporary todo list needed to correctly process loops in jitc_var_traverse()
 static std::vector<VisitedKey> visit_later;
 
+/// Temporary data structures used to split oversized kernels (jitc_split_groups())
+static std::vector<ScheduledVariable> split_schedule;
+static std::vector<ScheduledGroup> split_groups;
+static std::vector<uint32_t> split_last_use, split_cuts, split_marker;
+static std::vector<int32_t> split_cost, split_blocked;
+tsl::robin_set<uint32_t, UInt64Hasher> split_shared;
+
+/// Per-variable estimates computed by jitc_eval_cost_model()
+struct EvalCost {
+    uint32_t ops;   // Operations needed to recompute the variable
+    uint32_t bytes; // Bytes per element loaded to recompute the variable
+    uint32_t refs;  // References held by the schedule and by its variables
+};
+static std::vector<EvalCost> eval_cost;
+
 // ====================================================================
 
 // Don't perform scatters, whose output buffer is found to be unreferenced
@@ -123,6 +138,13 @@ static void jitc_var_traverse(uint32_t size, uint32_t index, uint32_t depth = 0)
 
     Variable *v = jitc_var(index);
     switch ((VarKind) v->kind) {
+        case VarKind::Evaluated:
+            if (unlikely(!v->data))
+                jitc_raise("jit_eval(): variable r%u was computed by a "
+                           "cancelled kernel and has been released (see "
+                           "jit_cancel())!", index);
+            break;
+
         case VarKind::Scatter:
             if (jitc_var_maybe_suppress_scatter(index, v, depth))
                 return;
@@ -223,6 +245,23 @@ static void jitc_var_traverse(uint32_t size, uint32_t index, uint32_t depth = 0)
     }
 }
 
+/// Replace '^'s in '__raygen__^^^..' or 'drjit_^^^..' with the kernel hash
+static void jitc_assemble_hash() {
+    kernel_hash = hash_kernel(buffer.get());
+
+    size_t hash_offset = strchr(buffer.get(), '^') - buffer.get(),
+           end_offset = buffer.size(),
+           prefix_len = uses_optix ? 10 : 6;
+
+    buffer.rewind_to(hash_offset);
+    buffer.put_q64_unchecked(kernel_hash.high64);
+    buffer.put_q64_unchecked(kernel_hash.low64);
+    buffer.rewind_to(end_offset);
+    memset(kernel_name, 0, sizeof(kernel_name));
+    memcpy(kernel_name, buffer.get() + hash_offset - prefix_len,
+           prefix_len + 32);
+}
+
 void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
     JitBackend backend = ts->backend;
 
@@ -410,20 +449,7 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
     else
         jitc_llvm_assemble(ts, group);
 
-    // Replace '^'s in '__raygen__^^^..' or 'drjit_^^^..' with hash
-    kernel_hash = hash_kernel(buffer.get());
-
-    size_t hash_offset = strchr(buffer.get(), '^') - buffer.get(),
-           end_offset = buffer.size(),
-           prefix_len = uses_optix ? 10 : 6;
-
-    buffer.rewind_to(hash_offset);
-    buffer.put_q64_unchecked(kernel_hash.high64);
-    buffer.put_q64_unchecked(kernel_hash.low64);
-    buffer.rewind_to(end_offset);
-    memset(kernel_name, 0, sizeof(kernel_name));
-    memcpy(kernel_name, buffer.get() + hash_offset - prefix_len,
-           prefix_len + 32);
+    jitc_assemble_hash();
 
     if (uses_optix && callable_count > 0) {
         // Work around a bug in OptiX with driver version 570. When a two
@@ -485,6 +511,75 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
 
 static ProfilerRegion profiler_region_backend_compile("jit_eval: compiling");
 
+/// Generate the LLVM IR of a group that was set up by jitc_assemble() again
+static void jitc_llvm_reassemble(ThreadState *ts, ScheduledGroup group) {
+    globals.clear();
+    globals_map.clear();
+    alloca_size = alloca_align = -1;
+    callable_count = 0;
+    callable_count_unique = 0;
+
+    // Code generation may have rewritten register indices (e.g., of loops)
+    uint32_t n_regs = 1;
+    for (uint32_t group_index = group.start; group_index != group.end; ++group_index) {
+        Variable *v = jitc_var(schedule[group_index].index);
+        v->reg_index = n_regs++;
+        v->ssa_f32_cast = 0;
+    }
+
+    buffer.clear();
+    jitc_llvm_assemble(ts, group);
+    jitc_assemble_hash();
+}
+
+/**
+ * Compile the kernel of 'group' for the portable x86-64 levels other than the
+ * current one and add the result to the disk cache, so that machines with a
+ * different processor find it there (see jit_llvm_set_portable()). The IR of
+ * the current level is restored afterwards. Kernels with function calls are
+ * skipped, since their callables are shared with other kernels.
+ */
+static void jitc_llvm_pregenerate_levels(ThreadState *ts, ScheduledGroup group) {
+    uint32_t level = jitc_llvm_isa_level;
+    if (level == 0 || callable_count > 0)
+        return;
+
+    XXH128_hash_t hash = kernel_hash;
+
+    /* Other threads must not observe the temporary change of the target
+       (which affects the vector width), hence both locks remain held */
+    lock_guard guard(state.compile_lock);
+
+    for (uint32_t l = 3; l <= 4; ++l) {
+        if (l == level)
+            continue;
+
+        jitc_llvm_set_isa_level(l);
+        jitc_llvm_reassemble(ts, group);
+
+        if (jitc_kernel_cached(ts->backend, kernel_hash))
+            continue;
+
+        Kernel kernel;
+        memset(&kernel, 0, sizeof(Kernel));
+        jitc_llvm_compile(kernel);
+        jitc_kernel_write(buffer.get(), (uint32_t) buffer.size(), ts->backend,
+                          kernel_hash, kernel);
+        jitc_kernel_free(ts->device, kernel);
+
+        jitc_log(Info, "     pregenerated x86-64-v%u variant %016llx.", l,
+                 (unsigned long long) kernel_hash.high64);
+    }
+
+    jitc_llvm_set_isa_level(level);
+    jitc_llvm_reassemble(ts, group);
+
+    // The kernel that is about to be launched must not have changed
+    jitc_assert(kernel_hash.high64 == hash.high64 &&
+                kernel_hash.low64 == hash.low64,
+                "jitc_llvm_pregenerate_levels(): reassembly changed the kernel!");
+}
+
 Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
     uint64_t flags = 0;
 
@@ -527,10 +622,22 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
 
 			if (!cache_hit) {
 				ProfilerPhase profiler(profiler_region_backend_compile);
-				jitc_llvm_compile(kernel);
+                {
+                    /* Compile without holding the central lock, so that
+                       other threads can trace in the meantime ('eval_lock'
+                       is still held) */
+                    unlock_guard guard(state.lock);
+                    lock_guard guard_2(state.compile_lock);
+                    jitc_llvm_compile(kernel);
+                }
                 jitc_kernel_write(buffer.get(), (uint32_t) buffer.size(),
                                   ts->backend, kernel_hash, kernel);
 				jitc_llvm_disasm(kernel);
+
+                if (jitc_llvm_pregenerate) {
+                    jitc_llvm_pregenerate_levels(ts, group);
+                    kernel_key.str = (char *) buffer.get();
+                }
 			}
 		}
 
@@ -565,9 +672,16 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
                 std::string(jitc_time_string(link_time)).c_str(),
                 std::string(jitc_mem_string(kernel.size)).c_str());
 
-        kernel_key.str = (char *) malloc_check(buffer.size() + 1);
-        memcpy(kernel_key.str, buffer.get(), buffer.size() + 1);
-        state.kernel_cache.emplace(kernel_key, kernel);
+        // The kernel cache may have changed while the lock was released
+        it = state.kernel_cache.find(kernel_key);
+        if (unlikely(it != state.kernel_cache.end())) {
+            jitc_kernel_free(ts->device, kernel);
+            kernel = it.value();
+        } else {
+            kernel_key.str = (char *) malloc_check(buffer.size() + 1);
+            memcpy(kernel_key.str, buffer.get(), buffer.size() + 1);
+            state.kernel_cache.emplace(kernel_key, kernel);
+        }
 
         if (cache_hit)
             state.kernel_soft_misses++;
@@ -613,6 +727,398 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
     return ret_task;
 }
 
+/// Can a kernel containing this kind of variable be split into several parts?
+static bool jitc_split_supported(VarKind kind) {
+    switch (kind) {
+        case VarKind::Gather:
+        case VarKind::Scatter:
+        case VarKind::ScatterKahan:
+        case VarKind::BoundsCheck:
+        case VarKind::Counter:
+        case VarKind::DefaultMask:
+            return true;
+
+        default:
+            return kind >= VarKind::Evaluated && kind <= VarKind::Bitcast;
+    }
+}
+
+/// Split cost of a variable whose value is needed by a subsequent kernel
+enum class SplitCost { Free, Store, Blocked };
+
+static SplitCost jitc_split_cost(const Variable *v, uint32_t size) {
+    VarKind kind = (VarKind) v->kind;
+
+    // These can simply be re-emitted by the subsequent kernel
+    if (kind == VarKind::Evaluated || kind == VarKind::Literal ||
+        kind == VarKind::Undefined || kind == VarKind::Counter)
+        return SplitCost::Free;
+
+    // Everything else must be stored to memory
+    if (v->size != size || v->is_array() ||
+        (VarType) v->type == VarType::Void ||
+        (VarType) v->type == VarType::Pointer)
+        return SplitCost::Blocked;
+
+    // .. which happens anyways if the variable is an output of the kernel
+    return v->output_flag ? SplitCost::Free : SplitCost::Store;
+}
+
+/// Position of a dependency within the group being split (or -1)
+static uint32_t jitc_split_pos(uint32_t index, uint32_t start, uint32_t n) {
+    uint32_t pos = jitc_var(index)->reg_index - 1;
+    if (pos < n && schedule[start + pos].index == index)
+        return pos;
+    return (uint32_t) -1;
+}
+
+/**
+ * \brief Partition scheduled groups that exceed the kernel size threshold
+ *
+ * The schedule is ordered so that every variable follows its dependencies.
+ * Cutting a group at position 'c' therefore produces a valid kernel from the
+ * prefix. The remainder can access every value from the prefix that it needs,
+ * as long as that value is stored to memory (or trivially re-emitted, in the
+ * case of literals and such). This function greedily chooses cut points that
+ * minimize the number of stored values and then rewrites 'schedule' and
+ * 'schedule_groups'. Values crossing a cut are flagged as kernel outputs and
+ * duplicated into the schedule of the consuming part, where they turn into
+ * kernel inputs once \ref jitc_split_materialize() has run.
+ */
+static void jitc_split_groups(uint32_t threshold) {
+    bool split = false;
+
+    for (const ScheduledGroup &group : schedule_groups) {
+        if (group.end - group.start > threshold) {
+            split = true;
+            break;
+        }
+    }
+
+    if (!split)
+        return;
+
+    split_schedule.clear();
+    split_groups.clear();
+
+    for (const ScheduledGroup &group : schedule_groups) {
+        uint32_t start = group.start, n = group.end - group.start;
+        bool splittable = n > threshold;
+
+        for (uint32_t i = 0; splittable && i < n; ++i)
+            splittable = jitc_split_supported(
+                (VarKind) jitc_var(schedule[start + i].index)->kind);
+
+        if (!splittable) {
+            if (n > threshold)
+                jitc_log(Debug, "jit_eval(): kernel with %u operations contains "
+                         "unsupported operations and cannot be split.", n);
+
+            uint32_t offset = (uint32_t) split_schedule.size();
+            split_schedule.insert(split_schedule.end(),
+                                  schedule.begin() + group.start,
+                                  schedule.begin() + group.end);
+            split_groups.emplace_back(group.size, offset, offset + n);
+            continue;
+        }
+
+        // Temporarily stash the position of each variable in 'reg_index'
+        for (uint32_t i = 0; i < n; ++i)
+            jitc_var(schedule[start + i].index)->reg_index = i + 1;
+
+        split_last_use.resize(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            split_last_use[i] = i;
+            const Variable *v = jitc_var(schedule[start + i].index);
+            for (int j = 0; j < 4; ++j) {
+                uint32_t index2 = v->dep[j];
+                if (!index2)
+                    break;
+                uint32_t pos = jitc_split_pos(index2, start, n);
+                if (pos != (uint32_t) -1)
+                    split_last_use[pos] = std::max(split_last_use[pos], i);
+            }
+        }
+
+        /* Cost of cutting before position 'c' (i.e., kernel 1 = [0, c)):
+           every value defined before 'c' and used at or after 'c' crosses
+           the cut. Accumulate this with a difference array. */
+        split_cost.assign(n + 1, 0);
+        split_blocked.assign(n + 1, 0);
+        for (uint32_t i = 0; i < n; ++i) {
+            if (split_last_use[i] == i)
+                continue;
+            SplitCost cost = jitc_split_cost(
+                jitc_var(schedule[start + i].index), group.size);
+            std::vector<int32_t> &target =
+                cost == SplitCost::Blocked ? split_blocked : split_cost;
+            if (cost != SplitCost::Free) {
+                target[i + 1]++;
+                target[split_last_use[i] + 1]--;
+            }
+        }
+        for (uint32_t i = 1; i <= n; ++i) {
+            split_cost[i] += split_cost[i - 1];
+            split_blocked[i] += split_blocked[i - 1];
+        }
+
+        // Greedily choose the cheapest cut within the permitted window
+        split_cuts.clear();
+        for (uint32_t p = 0; n - p > threshold; ) {
+            uint32_t best = 0;
+            for (uint32_t c = p + std::max(threshold / 2, 1u);
+                 c <= p + threshold; ++c) {
+                if (split_blocked[c] == 0 &&
+                    (!best || split_cost[c] <= split_cost[best]))
+                    best = c;
+            }
+            if (!best)
+                break;
+            split_cuts.push_back(best);
+            p = best;
+        }
+        split_cuts.push_back(n);
+
+        // Emit the parts, prepending the values needed from previous parts
+        split_marker.assign(n, 0);
+        uint32_t part_start = 0, n_stored = 0;
+        for (uint32_t part = 0; part < split_cuts.size(); ++part) {
+            uint32_t part_end = split_cuts[part],
+                     offset = (uint32_t) split_schedule.size();
+
+            for (uint32_t i = part_start; i < part_end; ++i) {
+                const Variable *v = jitc_var(schedule[start + i].index);
+                for (int j = 0; j < 4; ++j) {
+                    uint32_t index2 = v->dep[j];
+                    if (!index2)
+                        break;
+                    uint32_t pos = jitc_split_pos(index2, start, n);
+                    if (pos < part_start)
+                        split_marker[pos] = part + 1;
+                }
+            }
+
+            // Scan in schedule order to ensure deterministic kernel hashes
+            for (uint32_t i = 0; i < part_start; ++i) {
+                if (split_marker[i] != part + 1)
+                    continue;
+                const ScheduledVariable &sv = schedule[start + i];
+                Variable *v = jitc_var(sv.index);
+                split_shared.insert(sv.index);
+                if (jitc_split_cost(v, group.size) == SplitCost::Store) {
+                    v->output_flag = true;
+                    n_stored++;
+                }
+                jitc_var_inc_ref(sv.index, v);
+                split_schedule.emplace_back(sv.size, sv.scope, sv.index);
+            }
+
+            split_schedule.insert(split_schedule.end(),
+                                  schedule.begin() + start + part_start,
+                                  schedule.begin() + start + part_end);
+            split_groups.emplace_back(group.size, offset,
+                                      (uint32_t) split_schedule.size(),
+                                      part + 1 < split_cuts.size());
+            part_start = part_end;
+        }
+
+        for (uint32_t i = 0; i < n; ++i)
+            jitc_var(schedule[start + i].index)->reg_index = 0;
+
+        if (split_cuts.size() > 1)
+            jitc_log(Info,
+                     "jit_eval(): split kernel with %u operations into %zu "
+                     "parts, %u intermediate value%s stored to memory.", n,
+                     split_cuts.size(), n_stored, n_stored == 1 ? "" : "s");
+    }
+
+    schedule.swap(split_schedule);
+    schedule_groups.swap(split_groups);
+}
+
+/**
+ * \brief Turn the outputs of a kernel into evaluated variables
+ *
+ * This is done once the first part of a split kernel has been launched, so
+ * that the subsequent part loads these values from memory.
+ */
+static void jitc_split_materialize(ThreadState *ts, ScheduledGroup group) {
+    for (uint32_t i = group.start; i != group.end; ++i) {
+        const ScheduledVariable &sv = schedule[i];
+        Variable *v = jitc_var(sv.index);
+
+        if (!v->output_flag || v->size != sv.size || !sv.data)
+            continue;
+
+        jitc_lvn_drop(sv.index, v);
+        v->kind = (uint32_t) VarKind::Evaluated;
+        v->data = sv.data;
+        v->output_flag = false;
+        v->consumed = false;
+
+        if (ts->cancelled)
+            ts->unsynced_outputs.emplace_back(sv.index, v->counter);
+
+        uint32_t dep[4];
+        memcpy(dep, v->dep, sizeof(uint32_t) * 4);
+        memset(v->dep, 0, sizeof(uint32_t) * 4);
+
+        for (int j = 0; j < 4; ++j)
+            jitc_var_dec_ref(dep[j]);
+    }
+}
+
+/**
+ * \brief Decide which scheduled variables should be stored to memory
+ *
+ * Storing a variable costs one write, and one read by each subsequent kernel
+ * consuming it. Not storing it means that each of these kernels must instead
+ * recompute the expression, including loads of the evaluated arrays it
+ * depends on. With 'c' consumers, a variable is stored when
+ *
+ *     size * (1 + c) < c * (ops + bytes),
+ *
+ * where operations and bytes are assumed to have a similar cost. The number
+ * of consumers is estimated from references that don't originate from the
+ * current schedule (e.g., arrays held by the application, or unevaluated
+ * variables that will be part of future kernels).
+ *
+ * Variables scheduled via \ref jit_var_schedule() may therefore stay
+ * unevaluated, while unscheduled intermediates can turn into outputs.
+ */
+static void jitc_eval_cost_model() {
+    const uint32_t n = (uint32_t) schedule.size(),
+                   limit = 1u << 20;
+
+    // Stash the position of the first occurrence of each variable
+    for (uint32_t i = n; i > 0; --i)
+        jitc_var(schedule[i - 1].index)->reg_index = i;
+
+    auto pos = [n](const Variable *v, uint32_t index) -> uint32_t {
+        uint32_t p = v->reg_index - 1;
+        return (p < n && schedule[p].index == index) ? p : (uint32_t) -1;
+    };
+
+    eval_cost.assign(n, EvalCost{ 0, 0, 0 });
+
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t index = schedule[i].index;
+        const Variable *v = jitc_var(index);
+        uint32_t p = pos(v, index);
+        if (p == (uint32_t) -1)
+            continue;
+
+        EvalCost &ec = eval_cost[p];
+        ec.refs++;
+        if (p != i)
+            continue;
+
+        VarKind kind = (VarKind) v->kind;
+        if (kind == VarKind::Evaluated) {
+            ec.bytes = v->size > 1 ? type_size[v->type] : 0;
+            continue;
+        } else if (kind == VarKind::Literal || kind == VarKind::Undefined) {
+            continue;
+        }
+
+        bool plain = jitc_split_supported(kind) && !v->is_array();
+        ec.ops = plain ? 1 : limit;
+        ec.bytes = kind == VarKind::Gather ? type_size[v->type] : 0;
+
+        for (int j = 0; j < 4; ++j) {
+            uint32_t index2 = v->dep[j];
+            if (!index2)
+                break;
+            uint32_t p2 = pos(jitc_var(index2), index2);
+            if (p2 == (uint32_t) -1) {
+                ec.ops = limit;
+                continue;
+            }
+            const EvalCost &ec2 = eval_cost[p2];
+            eval_cost[p2].refs++;
+            ec.ops = std::min(ec.ops + ec2.ops, limit);
+            ec.bytes = std::min(ec.bytes + ec2.bytes, limit);
+        }
+    }
+
+    uint32_t n_deferred = 0, n_stored = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        const ScheduledVariable &sv = schedule[i];
+        Variable *v = jitc_var(sv.index);
+        if (v->reg_index != i + 1)
+            continue;
+        v->reg_index = 0;
+
+        const EvalCost &ec = eval_cost[i];
+        if (!jitc_split_supported((VarKind) v->kind) || v->is_evaluated() ||
+            v->is_literal() || v->is_undefined() || v->is_array() ||
+            v->side_effect || v->size != sv.size ||
+            (VarType) v->type == VarType::Void ||
+            (VarType) v->type == VarType::Pointer || ec.ops >= limit)
+            continue;
+
+        uint64_t c = v->ref_count > ec.refs ? v->ref_count - ec.refs : 0,
+                 isize = type_size[v->type];
+        bool store = isize * (1 + c) < c * (uint64_t) (ec.ops + ec.bytes);
+
+        if (v->output_flag && v->deferrable && !store) {
+            v->output_flag = false;
+            n_deferred++;
+        } else if (!v->output_flag && store && c > 0) {
+            v->output_flag = true;
+            n_stored++;
+        }
+    }
+
+    // Reset stashed positions of variables that occur multiple times
+    for (uint32_t i = 0; i < n; ++i)
+        jitc_var(schedule[i].index)->reg_index = 0;
+
+    if (n_deferred || n_stored)
+        jitc_log(Debug,
+                 "jit_eval(): cost model deferred %u scheduled variable%s and "
+                 "stored %u intermediate%s.",
+                 n_deferred, n_deferred == 1 ? "" : "s", n_stored,
+                 n_stored == 1 ? "" : "s");
+}
+
+/// Does a group compute anything that is observable after the kernel finishes?
+static bool jitc_group_has_effect(ScheduledGroup group) {
+    for (uint32_t i = group.start; i != group.end; ++i) {
+        const Variable *v = jitc_var(schedule[i].index);
+        if (v->side_effect ||
+            (v->output_flag && v->size == group.size && !v->is_evaluated()))
+            return true;
+    }
+    return false;
+}
+
+/// Does this group only access memory at the current element index?
+static bool jitc_pipeline_supported(ScheduledGroup group) {
+    for (uint32_t i = group.start; i != group.end; ++i) {
+        const Variable *v = jitc_var(schedule[i].index);
+        if (v->side_effect)
+            return false;
+
+        switch ((VarKind) v->kind) {
+            case VarKind::Gather:
+            case VarKind::Scatter:
+            case VarKind::ScatterInc:
+            case VarKind::ScatterKahan:
+            case VarKind::PacketGather:
+            case VarKind::PacketScatter:
+            case VarKind::SearchSorted:
+            case VarKind::Call:
+            case VarKind::TraceRay:
+                return false;
+
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
 static ProfilerRegion profiler_region_eval("jit_eval");
 
 // Forward declaration
@@ -620,18 +1126,22 @@ void jitc_eval_impl(ThreadState *ts);
 
 /// Evaluate all computation that is queued on the given ThreadState
 void jitc_eval(ThreadState *ts) {
-    if (!ts || (ts->scheduled.empty() && ts->side_effects.empty()))
+    if (!ts || (ts->scheduled.empty() && ts->scheduled_deferrable.empty() &&
+                ts->side_effects.empty()))
         return;
 
     ProfilerPhase profiler(profiler_region_eval);
 
-    /* The function 'jitc_eval()' modifies several global data structures
-       and should never be executed concurrently. However, there are a few
-       places where it needs to temporarily release the main lock as part of
-       its work, which is dangerous because another thread could use that
-       opportunity to enter 'jitc_eval()' and cause corruption. The following
-       therefore temporarily unlocks 'state.lock' and then locks a separate
-       lock 'state.eval_lock' specifically guarding these data structures */
+    /* 'jitc_eval()' stores scratch information (register indices, parameter
+       types, ..) in the shared variable table, and value numbering may
+       implicitly share variables between threads. It must therefore never
+       be executed concurrently. However, it temporarily releases the main
+       lock to allocate memory and to compile LLVM kernels, during which other
+       threads may continue to trace computation. The following therefore
+       temporarily unlocks 'state.lock' and then locks a separate lock
+       'state.eval_lock' that serializes evaluation. Kernel launches remain
+       ordered on the shared task chain, since memory released by a kernel
+       of one thread may be reused by the next kernel of another thread. */
 
     {
         lock_release(state.lock);
@@ -667,33 +1177,64 @@ void jitc_eval_impl(ThreadState *ts) {
     visited.clear();
     visit_later.clear();
     schedule.clear();
+    split_shared.clear();
+
+    try {
+        /* Process deferrable requests first, so that a variable that was also
+           scheduled via jitc_var_schedule_force() or internally is never
+           downgraded by a subsequent jit_var_schedule() */
+        for (int deferrable = 1; deferrable >= 0; --deferrable) {
+            std::vector<WeakRef> &list =
+                deferrable ? ts->scheduled_deferrable : ts->scheduled;
+
+            for (WeakRef wr: list) {
+                // Skip variables that expired, or which we already evaluated
+                Variable *v = jitc_var(wr);
+                if (!v || v->is_evaluated())
+                    continue;
+                jitc_var_traverse(v->size, wr.index);
+                v->output_flag = true;
+                v->deferrable = deferrable;
+            }
 
-    for (WeakRef wr: ts->scheduled) {
-        // Skip variables that expired, or which we already evaluated
-        Variable *v = jitc_var(wr);
-        if (!v || v->is_evaluated())
-            continue;
-        jitc_var_traverse(v->size, wr.index);
-        v->output_flag = true;
-    }
-
-    ts->scheduled.clear();
+            list.clear();
+        }
 
-    for (uint32_t index: ts->side_effects)
-        jitc_var_traverse(jitc_var(index)->size, index);
+        for (uint32_t index: ts->side_effects)
+            jitc_var_traverse(jitc_var(index)->size, index);
 
-    ts->side_effects.clear();
+        ts->side_effects.clear();
 
-    // Should not be replaced by a range-based for loop,
-    // as the traversal may append further items
-    for (size_t i = 0; i < visit_later.size(); ++i) {
-        VisitedKey vk = visit_later[i];
-        jitc_var_traverse(vk.size, vk.index, vk.depth);
+        // Should not be replaced by a range-based for loop,
+        // as the traversal may append further items
+        for (size_t i = 0; i < visit_later.size(); ++i) {
+            VisitedKey vk = visit_later[i];
+            jitc_var_traverse(vk.size, vk.index, vk.depth);
+        }
+    } catch (...) {
+        /* The computation cannot be evaluated (e.g., since it references the
+           released output of a cancelled kernel). Drop the pending requests
+           and the references held by the partial schedule. */
+        ts->scheduled.clear();
+        ts->scheduled_deferrable.clear();
+        for (const ScheduledVariable &sv : schedule) {
+            Variable *v = jitc_var(sv.index);
+            v->output_flag = false;
+            jitc_var_dec_ref(sv.index, v);
+        }
+        schedule.clear();
+        throw;
     }
 
     if (schedule.empty())
         return;
 
+    uint32_t flags = jitc_flags();
+    bool cost_model = (flags & (uint32_t) JitFlag::EvalCostModel) &&
+                     !(flags & (uint32_t) JitFlag::FreezingScope);
+    if (unlikely(cost_model))
+        jitc_eval_cost_model();
+
     // Order variables into groups of matching size
     std::stable_sort(
         schedule.begin(), schedule.end(),
@@ -728,21 +1269,53 @@ void jitc_eval_impl(ThreadState *ts) {
                                      cur, (uint32_t) schedule.size());
     }
 
+    if (kernel_split_threshold)
+        jitc_split_groups(kernel_split_threshold);
+
     jitc_log(Info, "jit_eval(): launching %zu kernel%s.",
             schedule_groups.size(),
             schedule_groups.size() == 1 ? "" : "s");
 
     scoped_set_context_maybe guard2(ts->context);
 
-    for (ScheduledGroup &group : schedule_groups) {
+    uint32_t n_launched = 0;
+    for (size_t i = 0; i < schedule_groups.size(); ++i) {
+        ScheduledGroup group = schedule_groups[i];
+
+        // The cost model may have removed all outputs from this group
+        if (unlikely(cost_model) && !jitc_group_has_effect(group))
+            continue;
+
+        // The next kernel is the continuation of a split kernel (see
+        // jitc_split_groups()) and reads values produced by this one
+        bool split = group.continued;
+
+        // If both only access memory at the current element index, the
+        // continuation can be pipelined with this kernel
+        bool pipelined =
+            split && !(flags & ((uint32_t) JitFlag::KernelHistory |
+                                (uint32_t) JitFlag::LaunchBlocking)) &&
+            (!cost_model || jitc_group_has_effect(schedule_groups[i + 1])) &&
+            jitc_pipeline_supported(group) &&
+            jitc_pipeline_supported(schedule_groups[i + 1]) &&
+            ts->pipeline();
+
         jitc_assemble(ts, group);
 
         jitc_run(ts, group);
+        n_launched++;
+
+        if (split) {
+            if (!pipelined)
+                ts->barrier();
+            jitc_split_materialize(ts, group);
+        }
     }
 
     // The barrier ensures that subsequently launched kernels can't start to run
     // until all kernels in the current launch have finished.
-    ts->barrier();
+    if (n_launched)
+        ts->barrier();
 
     /* Variables and their dependencies are now computed, hence internal edges
        between them can be removed. This will cause many variables to expire. */
@@ -780,6 +1353,10 @@ void jitc_eval_impl(ThreadState *ts) {
 
             if (v->is_array())
                 v->scope = 0;
+
+            // Released if the computation turns out to have been cancelled
+            if (ts->cancelled)
+                ts->unsynced_outputs.emplace_back(index, v->counter);
         }
 
         uint32_t dep[4], side_effect = v->side_effect;
@@ -12,6 +12,7 @@
 #include "internal.h"
 #include "strbuf.h"
 #include <map>
+#include <tsl/robin_set.h>
 
 /// A single variable that is scheduled to execute for a launch with 'size' entries
 struct ScheduledVariable {
@@ -30,8 +31,12 @@ struct ScheduledGroup {
     uint32_t start;
     uint32_t end;
 
-    ScheduledGroup(uint32_t size, uint32_t start, uint32_t end)
-        : size(size), start(start), end(end) { }
+    /// Is this group followed by the next part of the same split kernel?
+    bool continued;
+
+    ScheduledGroup(uint32_t size, uint32_t start, uint32_t end,
+                   bool continued = false)
+        : size(size), start(start), end(end), continued(continued) { }
 };
 
 struct GlobalKey {
@@ -100,6 +105,12 @@ extern std::vector<ScheduledVariable> schedule;
 /// Groups of variables with the same size
 extern std::vector<ScheduledGroup> schedule_groups;
 
+/// Variables accessed by several parts of a split kernel (see \ref jitc_eval())
+extern tsl::robin_set<uint32_t, UInt64Hasher> split_shared;
+
+/// Split kernels with more operations than this (0: disabled, see api.cpp)
+extern uint32_t kernel_split_threshold;
+
 /// Evaluate all computation that is queued on the current thread
 extern void jitc_eval(ThreadState *ts);
 
@@ -14,10 +14,12 @@
 #include "internal.h"
 #include "log.h"
 #include "registry.h"
+#include "strtab.h"
 #include "var.h"
 #include "profile.h"
 #include "strbuf.h"
 #include <sys/stat.h>
+#include <thread>
 
 #include "nvtx_api.h"
 
@@ -36,6 +38,10 @@
 
 State state;
 
+/// Lock elision state (see \ref ElidableLock)
+std::atomic<bool> lock_elide { false };
+static std::thread::id lock_elide_owner;
+
 #if !defined(_WIN32)
   char* jitc_temp_path = nullptr;
 #else
@@ -162,6 +168,11 @@ void jitc_shutdown(int light) {
         if (!ts->mask_stack.empty() && state.leak_warnings)
             jitc_log(Warn, "jit_shutdown(): leaked %zu active masks!",
                      ts->mask_stack.size());
+        if (ts->backend == JitBackend::LLVM && ts->task != &jitc_task &&
+            *ts->task) {
+            task_wait_and_release(*ts->task);
+            *ts->task = nullptr;
+        }
     }
 
     if (jitc_task) {
@@ -238,7 +249,7 @@ void jitc_shutdown(int light) {
                     jitc_log(Warn,
                              "jit_shutdown(): leaked %zu prefix stack entries.",
                              ts->prefix_stack.size());
-                free(ts->prefix);
+                jitc_str_dec_ref(ts->prefix);
             }
 
             delete ts;
@@ -259,6 +270,11 @@ void jitc_shutdown(int light) {
         }
 
         pool_destroy();
+        if (jitc_llvm_pool_high) {
+            pool_destroy(jitc_llvm_pool_high);
+            jitc_llvm_pool_high = nullptr;
+        }
+        jitc_llvm_high_chains.clear();
         state.tss.clear();
     }
 
@@ -312,6 +328,7 @@ void jitc_shutdown(int light) {
     }
 
     jitc_registry_shutdown();
+    jitc_str_shutdown();
     jitc_malloc_shutdown();
     jitc_nvtx_shutdown();
 
@@ -335,6 +352,12 @@ void jitc_shutdown(int light) {
 ThreadState *jitc_init_thread_state(JitBackend backend) {
     ThreadState *ts;
 
+    if (unlikely(lock_elide.load(std::memory_order_relaxed) &&
+                 std::this_thread::get_id() != lock_elide_owner))
+        jitc_fail("jit_init_thread_state(): Dr.Jit is in single-threaded mode "
+                  "(see jit_set_single_threaded()), but it is being accessed "
+                  "from a different thread!");
+
     if (backend == JitBackend::CUDA) {
         ts = new CUDAThreadState();
         if ((state.backends & (uint32_t) JitBackend::CUDA) == 0) {
@@ -395,7 +418,8 @@ ThreadState *jitc_init_thread_state(JitBackend backend) {
         ts->sync_stream_event = device.sync_stream_event;
         thread_state_cuda = ts;
     } else {
-        ts = new LLVMThreadState();
+        LLVMThreadState *ts_llvm = new LLVMThreadState();
+        ts = ts_llvm;
         if ((state.backends & (uint32_t) JitBackend::LLVM) == 0) {
             delete ts;
             #if defined(_WIN32)
@@ -414,6 +438,8 @@ ThreadState *jitc_init_thread_state(JitBackend backend) {
         }
         thread_state_llvm = ts;
         ts->device = -1;
+        ts->task = &jitc_task;
+        ts->cancelled = &ts_llvm->cancel_flag;
     }
 
     ts->backend = backend;
@@ -466,28 +492,53 @@ void jitc_sync_thread(ThreadState *ts) {
         unlock_guard guard_2(state.lock);
         cuda_check(cuStreamSynchronize(stream));
     } else {
-        Task *task = jitc_task;
-        if (!task)
-            return;
-
-        /* task_wait allows other tasks from the thread pool to be
-         * started on this thread while we wait.
-         *
-         * However we don't want the ThreadState dynamic internal
-         * variables (e.g. scheduled, side_effects, mask_stack) to
-         * be shared across these tasks
-         */
-        scoped_reset_thread_state ts_guard(ts);
-        {
-            unlock_guard guard(state.lock);
-            task_wait(task);
-        }
-        // Clear 'jitc_task' if no work was added in the meantime
-        if (task == jitc_task) {
-            jitc_task = nullptr;
-            task_release(task);
+        Task *task = *ts->task;
+        if (task) {
+            /* task_wait allows other tasks from the thread pool to be
+             * started on this thread while we wait.
+             *
+             * However we don't want the ThreadState dynamic internal
+             * variables (e.g. scheduled, side_effects, mask_stack) to
+             * be shared across these tasks
+             */
+            scoped_reset_thread_state ts_guard(ts);
+            {
+                unlock_guard guard(state.lock);
+                task_wait(task);
+            }
+            // Clear the task chain if no work was added in the meantime
+            if (task == *ts->task) {
+                *ts->task = nullptr;
+                task_release(task);
+            }
         }
+
+        // Kernels that finished without being cancelled produced valid outputs
+        if (!ts->cancelled || !ts->cancelled->load(std::memory_order_relaxed))
+            ts->unsynced_outputs.clear();
+    }
+}
+
+void jitc_check_cancelled() {
+    ThreadState *ts = thread_state_llvm;
+    if (likely(!ts || !ts->cancelled ||
+               !ts->cancelled->load(std::memory_order_relaxed) ||
+               !ts->cancelled->exchange(false)))
+        return;
+
+    // The contents of recently computed outputs are undefined, release them
+    for (WeakRef wr : ts->unsynced_outputs) {
+        Variable *v = jitc_var(wr);
+        if (!v || !v->is_evaluated() || !v->data)
+            continue;
+        if (!v->retain_data)
+            jitc_free(v->data);
+        v->data = nullptr;
     }
+    ts->unsynced_outputs.clear();
+
+    jitc_raise("jit_sync_thread(): the computation was cancelled "
+               "(see jit_cancel())!");
 }
 
 /// Wait for all computation on the current stream to finish
@@ -525,27 +576,53 @@ void jitc_sync_all_devices() {
 }
 
 static void jitc_rebuild_prefix(ThreadState *ts) {
-    free(ts->prefix);
+    jitc_str_dec_ref(ts->prefix);
 
     if (!ts->prefix_stack.empty()) {
-        size_t size = 1;
-        for (const char *s : ts->prefix_stack)
-            size += strlen(s) + 1;
-        ts->prefix = (char *) malloc(size);
-        char *p = ts->prefix;
-
+        StringBuffer buf;
         for (const char *s : ts->prefix_stack) {
-            size_t len = strlen(s);
-            memcpy(p, s, len);
-            p += len;
-            *p++ = '/';
+            buf.put(s, strlen(s));
+            buf.put('/');
         }
-        *p++ = '\0';
+        ts->prefix = jitc_str_intern(buf.get(), buf.size());
     } else {
         ts->prefix = nullptr;
     }
 }
 
+void jitc_set_single_threaded(bool value) {
+    if (value == lock_elide.load(std::memory_order_relaxed))
+        return;
+
+    if (value) {
+        /* Every existing thread state must belong to the calling thread,
+           otherwise another thread has already used Dr.Jit */
+        for (ThreadState *ts : state.tss) {
+            if (ts != thread_state_llvm && ts != thread_state_cuda)
+                jitc_raise("jit_set_single_threaded(): cannot enable "
+                           "single-threaded mode, Dr.Jit has already been "
+                           "used from another thread!");
+        }
+        lock_elide_owner = std::this_thread::get_id();
+    } else if (std::this_thread::get_id() != lock_elide_owner) {
+        jitc_raise("jit_set_single_threaded(): single-threaded mode can only "
+                   "be disabled by the thread that enabled it!");
+    }
+
+    jitc_log(Info, "jit_set_single_threaded(): %s lock elision.",
+             value ? "enabling" : "disabling");
+    lock_elide.store(value, std::memory_order_relaxed);
+}
+
+#if !defined(NDEBUG)
+void lock_elide_check() {
+    if (std::this_thread::get_id() != lock_elide_owner)
+        jitc_fail("lock_elide_check(): Dr.Jit is in single-threaded mode (see "
+                  "jit_set_single_threaded()), but it is being accessed from a "
+                  "different thread!");
+}
+#endif
+
 void jitc_prefix_push(JitBackend backend, const char *label) {
     if (strchr(label, '\n') || strchr(label, '/'))
         jitc_raise("jit_prefix_push(): invalid string (may not contain newline "
@@ -750,8 +827,10 @@ void KernelHistory::clear() {
 /// Default implementations of ThreadState functions
 ThreadState::~ThreadState() { }
 void ThreadState::barrier() { }
+bool ThreadState::pipeline() { return false; }
 void ThreadState::reset_state() {
     scheduled.clear();
+    scheduled_deferrable.clear();
     side_effects.clear();
     side_effects_symbolic.clear();
     mask_stack.clear();
@@ -768,3 +847,13 @@ void ThreadState::reset_state() {
 }
 void ThreadState::notify_free(const void *) { }
 void ThreadState::notify_expand(uint32_t) { }
+void ThreadState::sort(VarType, uint32_t, const void *, const uint32_t *,
+                       void *, uint32_t *) {
+    jitc_raise("jit_sort(): this operation is currently only supported by "
+               "the LLVM backend!");
+}
+void ThreadState::histogram(VarType, uint32_t, const uint32_t *, const void *,
+                            uint32_t, void *) {
+    jitc_raise("jit_histogram(): this operation is currently only supported "
+               "by the LLVM backend!");
+}
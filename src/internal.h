@@ -15,6 +15,7 @@
 #include "llvm.h"
 #include "alloc.h"
 #include "io.h"
+#include <atomic>
 #include <queue>
 #include <string.h>
 #include <inttypes.h>
@@ -73,7 +74,7 @@ enum class VarKind : uint32_t {
     // Fast approximations
     Rcp, RcpApprox, RSqrtApprox,
 
-    // Multi-function generator (CUDA)
+    // Multi-function generator (CUDA), polynomial kernels (LLVM)
     Sin, Cos, Exp2, Log2,
 
     // Casts
@@ -91,9 +92,15 @@ enum class VarKind : uint32_t {
     // Scatter multiple contiguous values at once
     PacketScatter,
 
+    // Binary search within a sorted array
+    SearchSorted,
+
     // Counter node to determine the current lane ID
     Counter,
 
+    // Counter-based random number generator (Philox2x32-10)
+    Philox,
+
     // Default mask used to ignore out-of-range SIMD lanes (LLVM)
     DefaultMask,
 
@@ -257,8 +264,9 @@ struct alignas(64) Variable {
     /// If set, evaluation will have side effects on other variables
     uint32_t side_effect : 1;
 
-    /// Unused flag
-    uint32_t unused_2: 1;
+    /// Was this variable scheduled via jit_var_schedule() (as opposed to
+    /// an explicit evaluation)? See \ref JitFlag::EvalCostModel.
+    uint32_t deferrable : 1;
 
     // =========== Entries that are temporarily used in jitc_eval() ============
     // (+11 bits -> 32 bits with all the preceding individiual bits = 4 bytes)
@@ -325,8 +333,9 @@ static_assert(sizeof(Variable) == 64);
 /// since only very few variables need these fields, and to to ensure that
 /// ``sizeof(Variable) == 64`` (i.e. a variable fits into a L1 cache line)
 struct VariableExtra {
-    /// A human-readable variable label (for GraphViz visualizations, debugging LLVM/PTX IR)
-    char *label = nullptr;
+    /// A human-readable variable label (for GraphViz visualizations, debugging
+    /// LLVM/PTX IR). Interned and reference-counted, see strtab.h
+    const char *label = nullptr;
 
     /// Callback to be invoked when the variable is evaluated/deallocated
     void (*callback)(uint32_t, int, void *) = nullptr;
@@ -575,6 +584,13 @@ struct ThreadStateBase {
      */
     std::vector<WeakRef> scheduled;
 
+    /**
+     * Like 'scheduled', but the cost model of jitc_eval() may decide to leave
+     * these variables unevaluated (see \ref JitFlag::EvalCostModel). This
+     * does not apply to variables that also appear in 'scheduled'.
+     */
+    std::vector<WeakRef> scheduled_deferrable;
+
     /**
      * List of special variables of type VarType::Void, whose evaluation will
      * cause side effects that modify other variables. They will be evaluated
@@ -597,8 +613,8 @@ struct ThreadStateBase {
     /// Stack of symbolic recording sessions
     std::vector<std::string> record_stack;
 
-    /// Combined version of the elements of 'prefix_stack'
-    char *prefix = nullptr;
+    /// Combined version of the elements of 'prefix_stack' (interned)
+    const char *prefix = nullptr;
 
     /// Identifier associated with the current basic block
     uint32_t scope = 2;
@@ -609,6 +625,30 @@ struct ThreadStateBase {
     /// .. and the JIT variable that it will be mapped to
     uint32_t call_self_index = 0;
 
+    /// ---------------------------- LLVM-specific ----------------------------
+
+    /// Scheduling priority of kernels launched via this thread state
+    JitPriority priority = JitPriority::Normal;
+
+    /// Thread pool that processes these kernels (\c nullptr: default pool)
+    Pool *pool = nullptr;
+
+    /**
+     * \brief Tail of the dependency chain of kernels launched via this thread
+     * state. Refers to the shared 'jitc_task' unless a different priority
+     * was requested (see \ref jitc_llvm_set_priority()).
+     */
+    Task **task = nullptr;
+
+    /// Cancellation flag checked by the work units of kernels launched via
+    /// this thread state (see \ref jit_cancel())
+    std::atomic<bool> *cancelled = nullptr;
+
+    /// Outputs of kernels launched via this thread state since the last
+    /// synchronization. They are released if the computation turns out to
+    /// have been cancelled (see \ref jitc_check_cancelled())
+    std::vector<WeakRef> unsynced_outputs;
+
     /// ---------------------------- CUDA-specific ----------------------------
 
     /// Redundant copy of the device context
@@ -664,6 +704,20 @@ struct ThreadState : public ThreadStateBase {
      */
     virtual void barrier();
 
+    /**
+     * \brief Pipeline the next kernel launch with the following one
+     *
+     * The caller guarantees that the next two kernels have the same size,
+     * and that the second one only accesses outputs of the first one at the
+     * current element index. Instead of separating them with a \ref
+     * barrier(), the backend may then run them block by block, so that block
+     * 'i' of the second kernel only waits for block 'i' of the first one.
+     *
+     * Returns \c false if the backend does not support this, in which case
+     * the caller must insert a barrier as usual.
+     */
+    virtual bool pipeline();
+
     virtual Task *launch(Kernel kernel, KernelKey *key, XXH128_hash_t hash,
                          uint32_t size, std::vector<void *> *kernel_params,
                          const std::vector<uint32_t> *kernel_param_ids) = 0;
@@ -697,6 +751,15 @@ struct ThreadState : public ThreadStateBase {
                             uint32_t bucket_count, uint32_t *perm,
                             uint32_t *offsets) = 0;
 
+    /// Stable sort of an array of keys and (optionally) of associated values
+    virtual void sort(VarType vt, uint32_t size, const void *keys_in,
+                      const uint32_t *values_in, void *keys_out,
+                      uint32_t *values_out);
+
+    /// Accumulate (optionally weighted) entries of a 32-bit index array into bins
+    virtual void histogram(VarType vt, uint32_t size, const uint32_t *values,
+                           const void *weights, uint32_t bin_count, void *out);
+
     /// Perform a synchronous copy operation
     virtual void memcpy(void *dst, const void *src, size_t size) = 0;
 
@@ -796,7 +859,7 @@ using UnusedPQ = std::priority_queue<uint32_t, std::vector<uint32_t>, std::great
 /// Records the full JIT compiler state (most frequently two used entries at top)
 struct State {
     /// Must be held to access members of this data structure
-    Lock lock;
+    ElidableLock lock;
 
     /// Must be held to access 'state.alloc_free'
     Lock alloc_free_lock;
@@ -822,7 +885,12 @@ struct State {
     size_t variable_counter = 0;
 
     /// Must be held to execute jitc_eval()
-    Lock eval_lock;
+    ElidableLock eval_lock;
+
+    /// Must be held to compile LLVM kernels (which is done without holding
+    /// 'lock', see jitc_run()). The LLVM context, execution engine, and memory
+    /// manager are shared by all threads.
+    ElidableLock compile_lock;
 
     /// Log level (stderr)
     LogLevel log_level_stderr = LogLevel::Info;
@@ -886,12 +954,14 @@ struct State {
         lock_init(lock);
         lock_init(alloc_free_lock);
         lock_init(eval_lock);
+        lock_init(compile_lock);
     }
 
     ~State() {
         lock_destroy(lock);
         lock_destroy(alloc_free_lock);
         lock_destroy(eval_lock);
+        lock_destroy(compile_lock);
     }
 };
 
@@ -944,6 +1014,21 @@ extern void jitc_sync_thread();
 /// Wait for all computation on the current stream to finish
 extern void jitc_sync_thread(ThreadState *stream);
 
+/**
+ * \brief Raise an exception if the computation of the calling thread was
+ * cancelled via \ref jit_cancel(), and clear the cancellation request
+ *
+ * Before raising, the function frees the memory of kernel outputs that were
+ * produced since the last synchronization and sets their 'data' field to
+ * \c nullptr. Subsequent attempts to read or compute with them will raise.
+ *
+ * 'jitc_sync_thread()' does not do this itself, since it is also used
+ * internally in contexts that cannot propagate exceptions. This function
+ * should instead be called wherever the results of a computation are
+ * observed following a synchronization.
+ */
+extern void jitc_check_cancelled();
+
 /// Wait for all computation on the current device to finish
 extern void jitc_sync_device();
 
@@ -982,6 +1067,9 @@ extern void jitc_prefix_push(JitBackend backend, const char *label);
 /// Pop a label from the prefix stack
 extern void jitc_prefix_pop(JitBackend backend);
 
+/// Enable/disable elision of the central locks (see \ref jit_set_single_threaded())
+extern void jitc_set_single_threaded(bool value);
+
 JIT_MALLOC inline void* malloc_check(size_t size) {
     void *ptr = malloc(size);
     if (unlikely(!ptr)) {
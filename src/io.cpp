@@ -13,6 +13,7 @@
 #include "profile.h"
 #include "cuda.h"
 #include "optix.h"
+#include "llvm_arena.h"
 #include "resources/kernels.h"
 #include <stdexcept>
 #include <stdio.h>
@@ -24,11 +25,10 @@
 #  include <windows.h>
 #else
 #  include <unistd.h>
-#  include <sys/mman.h>
 #endif
 
 /// Version number for cache files
-#define DRJIT_CACHE_VERSION 5
+#define DRJIT_CACHE_VERSION 6
 
 // Uncomment to write out training data for creating a compression dictionary
 // #define DRJIT_CACHE_TRAIN 1
@@ -41,6 +41,7 @@ struct CacheFileHeader {
     uint32_t source_size;
     uint32_t kernel_size;
     uint32_t reloc_size;
+    uint32_t kernel_align;
 };
 #pragma pack(pop)
 
@@ -197,39 +198,23 @@ bool jitc_kernel_load(const char *source, uint32_t source_size,
             kernel.data = malloc_check(header.kernel_size);
             memcpy(kernel.data, uncompressed_data + source_size, header.kernel_size);
         } else {
-#if !defined(_WIN32)
-            kernel.data = mmap(nullptr, header.kernel_size, PROT_READ | PROT_WRITE,
-                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-            if (kernel.data == MAP_FAILED)
-                jitc_fail("jit_llvm_load(): could not mmap() memory: %s",
-                         strerror(errno));
-
-            memcpy(kernel.data, uncompressed_data + source_size, header.kernel_size);
-#else
-            kernel.data = VirtualAlloc(nullptr, header.kernel_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-            if (!kernel.data)
-                jitc_fail("jit_llvm_load(): could not VirtualAlloc() memory: %u", GetLastError());
-            memcpy(kernel.data, uncompressed_data + source_size, header.kernel_size);
+            uint8_t *rw = nullptr;
+            kernel.data = jitc_llvm_arena_alloc(header.kernel_size,
+                                                header.kernel_align, &rw);
+            memcpy(rw, uncompressed_data + source_size, header.kernel_size);
 
-#endif
             uintptr_t *reloc = (uintptr_t *) (uncompressed_data + header.source_size + padding_size + header.kernel_size);
             kernel.llvm.n_reloc = header.reloc_size / sizeof(void *);
             kernel.llvm.reloc = (void **) malloc(header.reloc_size);
+            kernel.llvm.align = header.kernel_align;
             for (uint32_t i = 0; i < kernel.llvm.n_reloc; ++i)
                 kernel.llvm.reloc[i] = (uint8_t *) kernel.data + reloc[i];
 
-            // Write address of @call_table
+            // Write address of @call_table (via the writable view of the kernel)
             if (kernel.llvm.n_reloc > 1)
-                *((void **) kernel.llvm.reloc[1]) = kernel.llvm.reloc + 1;
+                *((void **) (rw + reloc[1])) = kernel.llvm.reloc + 1;
 
-#if !defined(_WIN32)
-            if (mprotect(kernel.data, header.kernel_size, PROT_READ | PROT_EXEC) == -1)
-                jitc_fail("jit_llvm_load(): mprotect() failed: %s", strerror(errno));
-#else
-            DWORD unused;
-            if (VirtualProtect(kernel.data, header.kernel_size, PAGE_EXECUTE_READ, &unused) == 0)
-                jitc_fail("jit_llvm_load(): VirtualProtect() failed: %u", GetLastError());
-#endif
+            jitc_llvm_arena_publish(kernel.data, header.kernel_size);
 
 #if defined(DRJIT_ENABLE_ITTNOTIFY)
             char name[39];
@@ -253,6 +238,30 @@ bool jitc_kernel_load(const char *source, uint32_t source_size,
     return success;
 }
 
+bool jitc_kernel_cached(JitBackend backend, XXH128_hash_t hash) {
+#if !defined(_WIN32)
+    char filename[512];
+    if (unlikely(snprintf(filename, sizeof(filename), "%s/%016llx%016llx.%s.bin",
+                          jitc_temp_path, (unsigned long long) hash.high64,
+                          (unsigned long long) hash.low64,
+                          backend == JitBackend::CUDA ? "cuda" : "llvm") < 0))
+        jitc_fail("jit_kernel_cached(): scratch space for filename insufficient!");
+
+    return access(filename, R_OK) == 0;
+#else
+    wchar_t filename_w[512];
+    int rv = _snwprintf(filename_w, sizeof(filename_w) / sizeof(wchar_t),
+                        L"%s\\%016llx%016llx.%s.bin",
+                        jitc_temp_path, (unsigned long long) hash.high64,
+                        (unsigned long long) hash.low64,
+                        backend == JitBackend::CUDA ? L"cuda" : L"llvm");
+    if (rv < 0)
+        jitc_fail("jit_kernel_cached(): scratch space for filename insufficient!");
+
+    return GetFileAttributesW(filename_w) != INVALID_FILE_ATTRIBUTES;
+#endif
+}
+
 bool jitc_kernel_write(const char *source, uint32_t source_size,
                        JitBackend backend, XXH128_hash_t hash,
                        const Kernel &kernel) {
@@ -348,9 +357,12 @@ bool jitc_kernel_write(const char *source, uint32_t source_size,
     header.source_size = source_size;
     header.kernel_size = kernel.size;
     header.reloc_size = 0;
+    header.kernel_align = 0;
 
-    if (backend == JitBackend::LLVM)
+    if (backend == JitBackend::LLVM) {
         header.reloc_size = kernel.llvm.n_reloc * sizeof(void *);
+        header.kernel_align = kernel.llvm.align;
+    }
 
     uint32_t padding_size = compute_padding(header);
     uint32_t in_size = header.source_size + header.kernel_size
@@ -445,13 +457,7 @@ void jitc_kernel_free(int device_id, const Kernel &kernel) {
     if (device_id == -1) {
         if (kernel.llvm.n_reloc)
             free(kernel.llvm.reloc);
-#if !defined(_WIN32)
-        if (munmap((void *) kernel.data, kernel.size) == -1)
-            jitc_fail("jit_kernel_free(): munmap() failed!");
-#else
-        if (VirtualFree((void*) kernel.data, 0, MEM_RELEASE) == 0)
-            jitc_fail("jit_kernel_free(): VirtualFree() failed!");
-#endif
+        jitc_llvm_arena_free(kernel.data, kernel.size);
     } else {
         const Device &device = state.devices.at(device_id);
         scoped_set_context guard(device.context);
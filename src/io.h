@@ -44,6 +44,9 @@ struct Kernel {
             /// Length of the 'reloc' table
             uint32_t n_reloc;
 
+            /// Alignment of 'data' required by the kernel's sections
+            uint32_t align;
+
 #if defined(DRJIT_ENABLE_ITTNOTIFY)
             void *itt;
 #endif
@@ -72,6 +75,9 @@ extern bool jitc_kernel_load(const char *source, uint32_t source_size,
                              JitBackend backend, XXH128_hash_t hash,
                              Kernel &kernel);
 
+/// Check if the disk cache contains a kernel with the given hash
+extern bool jitc_kernel_cached(JitBackend backend, XXH128_hash_t hash);
+
 extern bool jitc_kernel_write(const char *source, uint32_t source_size,
                               JitBackend backend, XXH128_hash_t hash,
                               const Kernel &kernel);
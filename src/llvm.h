@@ -15,11 +15,31 @@
 
 // Forward declarations
 struct Task;
+struct Pool;
 struct Kernel;
+enum class JitPriority : uint32_t;
 
 /// Current top-level task in the task queue
 extern Task *jitc_task;
 
+/// Thread pool processing high-priority kernels (created on demand)
+extern Pool *jitc_llvm_pool_high;
+
+/// Number of threads of 'jitc_llvm_pool_high' (0: a quarter of the default pool)
+extern uint32_t jitc_llvm_priority_threads;
+
+/// Task chains of the LLVM thread states with high priority
+extern std::vector<Task **> jitc_llvm_high_chains;
+
+/// Change the scheduling priority of the current thread's LLVM kernels
+extern void jitc_llvm_set_priority(JitPriority priority);
+
+/// Set the size of the thread pool processing high-priority kernels
+extern void jitc_llvm_set_priority_thread_count(uint32_t size);
+
+/// Return the size of the thread pool processing high-priority kernels
+extern uint32_t jitc_llvm_priority_thread_count();
+
 /// Attempt to dynamically load LLVM into the process
 extern bool jitc_llvm_api_init();
 
@@ -73,9 +93,13 @@ extern char *jitc_llvm_u32_width_str;
 
 extern uint32_t jitc_llvm_block_size;
 
+/// Array size (in bytes) above which kernels use non-temporal accesses
+extern size_t llvm_nontemporal_threshold;
+
 /// Various hardware capabilities
 extern bool jitc_llvm_has_avx;
 extern bool jitc_llvm_has_avx512;
+extern bool jitc_llvm_has_avx512cd;
 extern bool jitc_llvm_has_neon;
 
 /// Try to load initialize LLVM backend
@@ -109,6 +133,18 @@ extern void jitc_llvm_set_target(const char *target_cpu,
                                  const char *target_features,
                                  uint32_t vector_width);
 
+/// Portable x86-64 microarchitecture level targeted by the backend (0: host CPU)
+extern uint32_t jitc_llvm_isa_level;
+
+/// Compile kernels for all portable levels following a cache miss?
+extern bool jitc_llvm_pregenerate;
+
+/// Target the host CPU or a portable x86-64 level (see jit_llvm_set_portable())
+extern void jitc_llvm_set_portable(uint32_t portable, bool pregenerate);
+
+/// Switch code generation to level 3 or 4, or back to the host CPU (level 0)
+extern void jitc_llvm_set_isa_level(uint32_t level);
+
 /// Insert a ray tracing function call into the LLVM program
 extern void jitc_llvm_ray_trace(uint32_t func, uint32_t scene, int shadow_ray,
                                 const uint32_t *in, uint32_t *out);
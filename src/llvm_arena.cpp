@@ -0,0 +1,355 @@
+/*
+    src/llvm_arena.cpp -- Shared executable memory for compiled LLVM kernels
+
+    Previously, every compiled kernel received its own anonymous mapping,
+    which was made executable via mprotect(). Since typical kernels are only
+    a few KiB large, this scattered code across many pages and wasted iTLB
+    entries, in addition to requiring two system calls per kernel.
+
+    This file implements a bump allocator that packs kernels into shared 2 MiB
+    chunks, which are backed by huge pages where the OS provides them. Each
+    chunk is mapped twice: an executable view (from which the kernels run)
+    and a writable view (through which new code is copied). No address is
+    therefore ever writable and executable at the same time, and publishing
+    a kernel requires no page protection changes that could interfere with
+    kernels in the same chunk that are concurrently running on other
+    threads. The writable view is dropped once a chunk is full, and chunks
+    are unmapped once all of their kernels have been evicted.
+
+    When dual mappings are unavailable (non-Linux platforms, or when
+    memfd_create() fails), the implementation falls back to one mapping per
+    kernel with an explicit RW -> RX transition.
+
+    Shared mappings remain shared with child processes created via fork().
+    The writable views are therefore excluded from the child (MADV_DONTFORK),
+    and both processes retire their current chunk when forking, so that
+    neither of them subsequently writes to code the other one may execute.
+
+    Copyright (c) 2024 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#include "llvm_arena.h"
+#include "log.h"
+#include <mutex>
+#include <vector>
+#include <cstring>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  include <errno.h>
+#  include <pthread.h>
+#endif
+
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+#  define DRJIT_CODE_ARENA 1
+#else
+#  define DRJIT_CODE_ARENA 0
+#endif
+
+/// Granularity of arena chunks (matches the size of a huge page)
+#define DRJIT_ARENA_CHUNK_SIZE (2 * 1024 * 1024)
+
+/// Minimum alignment of kernels within a chunk (one cache line)
+#define DRJIT_ARENA_ALIGN 64
+
+#if DRJIT_CODE_ARENA
+struct CodeChunk {
+    /// Executable view of the chunk
+    uint8_t *rx;
+
+    /// Writable view of the chunk (\c nullptr once the chunk is retired)
+    uint8_t *rw;
+
+    /// Size of the chunk and current bump allocation offset
+    size_t size, offset;
+
+    /// Number of kernels that are still resident in this chunk
+    uint32_t live;
+};
+
+/// List of chunks, the last entry is used for new allocations
+static std::vector<CodeChunk> arena_chunks;
+
+/// Protects 'arena_chunks' (kernels are compiled without holding 'state.lock')
+static std::mutex arena_lock;
+
+/// Set when dual mappings turned out to be unsupported
+static bool arena_disabled = false;
+
+/// Map the shared memory file 'fd' so that the view starts at a 2 MiB boundary
+static uint8_t *arena_map_aligned(int fd, size_t size, int prot) {
+    size_t padded = size + DRJIT_ARENA_CHUNK_SIZE;
+    void *base = mmap(nullptr, padded, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED)
+        return nullptr;
+
+    uintptr_t start = (uintptr_t) base,
+              aligned = (start + DRJIT_ARENA_CHUNK_SIZE - 1) &
+                        ~(uintptr_t) (DRJIT_ARENA_CHUNK_SIZE - 1);
+
+    if (aligned != start)
+        munmap(base, aligned - start);
+    munmap((void *) (aligned + size), start + padded - (aligned + size));
+
+    void *ptr = mmap((void *) aligned, size, prot, MAP_SHARED | MAP_FIXED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        int err = errno;
+        munmap((void *) aligned, size);
+        errno = err;
+        return nullptr;
+    }
+
+    return (uint8_t *) ptr;
+}
+
+/// Create a new chunk with a writable and an executable view
+static bool arena_chunk_create(size_t size, bool huge, CodeChunk &chunk) {
+    unsigned int flags = MFD_CLOEXEC;
+#if defined(MFD_HUGETLB)
+    if (huge)
+        flags |= MFD_HUGETLB;
+#else
+    if (huge)
+        return false;
+#endif
+
+    int fd = memfd_create("drjit-code", flags);
+    if (fd == -1)
+        return false;
+
+    int err = 0;
+    chunk.rx = chunk.rw = nullptr;
+    if (ftruncate(fd, (off_t) size) == 0) {
+        chunk.rx = arena_map_aligned(fd, size, PROT_READ | PROT_EXEC);
+        if (chunk.rx) {
+            void *rw = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, fd, 0);
+            if (rw != MAP_FAILED) {
+                chunk.rw = (uint8_t *) rw;
+            } else {
+                err = errno;
+                munmap(chunk.rx, size);
+                chunk.rx = nullptr;
+            }
+        } else {
+            err = errno;
+        }
+    } else {
+        err = errno;
+    }
+
+    // Don't let close() clobber the error reported by the caller
+    close(fd);
+
+    if (!chunk.rw) {
+        errno = err;
+        return false;
+    }
+
+    // Child processes must never write to code shared with the parent
+    madvise(chunk.rw, size, MADV_DONTFORK);
+
+    // Without explicit huge pages, advise the OS to convert to 2M pages
+    if (!huge)
+        madvise(chunk.rx, size, MADV_HUGEPAGE);
+
+    chunk.size = size;
+    chunk.offset = 0;
+    chunk.live = 0;
+
+    jitc_log(Debug, "jit_llvm_arena_alloc(): created %s code chunk (%s).",
+             huge ? "a huge page" : "a", jitc_mem_string(size));
+
+    return true;
+}
+
+static void arena_chunk_release(CodeChunk &chunk) {
+    if (chunk.rw)
+        munmap(chunk.rw, chunk.size);
+    munmap(chunk.rx, chunk.size);
+    chunk.rx = chunk.rw = nullptr;
+}
+
+/// Stop allocating from the current chunk (the caller must hold 'arena_lock')
+static void arena_retire_current() {
+    if (arena_chunks.empty())
+        return;
+
+    CodeChunk &chunk = arena_chunks.back();
+    if (!chunk.rw)
+        return;
+
+    if (chunk.live == 0) {
+        arena_chunk_release(chunk);
+        arena_chunks.pop_back();
+    } else {
+        munmap(chunk.rw, chunk.size);
+        chunk.rw = nullptr;
+    }
+}
+
+/* After fork(), the parent and the child share the executable views of all
+   chunks. Both therefore retire their current chunk (in the child, its
+   writable view doesn't exist due to MADV_DONTFORK), so that none of them
+   bump-allocates or rewinds memory containing code of the other process. */
+static void arena_atfork_prepare() { arena_lock.lock(); }
+static void arena_atfork_done() {
+    arena_retire_current();
+    arena_lock.unlock();
+}
+
+/// Return the chunk containing 'ptr', or -1 if it isn't owned by the arena
+static ptrdiff_t arena_find(const void *ptr) {
+    const uint8_t *p = (const uint8_t *) ptr;
+    for (size_t i = 0; i < arena_chunks.size(); ++i) {
+        const CodeChunk &c = arena_chunks[i];
+        if (p >= c.rx && p < c.rx + c.size)
+            return (ptrdiff_t) i;
+    }
+    return -1;
+}
+#endif
+
+void *jitc_llvm_arena_alloc(size_t size, size_t align, uint8_t **rw) {
+    if (align < DRJIT_ARENA_ALIGN)
+        align = DRJIT_ARENA_ALIGN;
+
+#if DRJIT_CODE_ARENA
+    {
+        std::lock_guard<std::mutex> guard(arena_lock);
+
+        if (!arena_disabled) {
+            static bool atfork_registered = false;
+            if (!atfork_registered) {
+                pthread_atfork(arena_atfork_prepare, arena_atfork_done,
+                               arena_atfork_done);
+                atfork_registered = true;
+            }
+
+            CodeChunk *chunk = arena_chunks.empty() ? nullptr : &arena_chunks.back();
+            size_t offset = 0;
+            if (chunk)
+                offset = (chunk->offset + align - 1) / align * align;
+
+            if (!chunk || !chunk->rw || offset + size > chunk->size) {
+                // Retire the current chunk, which can no longer be written
+                arena_retire_current();
+
+                size_t chunk_size =
+                    (size + DRJIT_ARENA_CHUNK_SIZE - 1) /
+                    DRJIT_ARENA_CHUNK_SIZE * DRJIT_ARENA_CHUNK_SIZE;
+
+                CodeChunk new_chunk;
+                if (arena_chunk_create(chunk_size, true, new_chunk) ||
+                    arena_chunk_create(chunk_size, false, new_chunk)) {
+                    arena_chunks.push_back(new_chunk);
+                    chunk = &arena_chunks.back();
+                    offset = 0;
+                } else {
+                    jitc_log(Warn, "jit_llvm_arena_alloc(): could not create a "
+                                   "shared code mapping (%s), falling back to "
+                                   "one mapping per kernel.", strerror(errno));
+                    arena_disabled = true;
+                    chunk = nullptr;
+                }
+            }
+
+            if (chunk) {
+                chunk->offset = offset + size;
+                chunk->live++;
+                *rw = chunk->rw + offset;
+                return chunk->rx + offset;
+            }
+        }
+    }
+#endif
+
+#if !defined(_WIN32)
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED)
+        jitc_fail("jit_llvm_arena_alloc(): could not mmap() memory: %s",
+                  strerror(errno));
+#else
+    void *ptr = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT,
+                             PAGE_READWRITE);
+    if (!ptr)
+        jitc_fail("jit_llvm_arena_alloc(): could not VirtualAlloc() memory: %u",
+                  GetLastError());
+#endif
+
+    *rw = (uint8_t *) ptr;
+    return ptr;
+}
+
+void jitc_llvm_arena_publish(void *ptr, size_t size) {
+#if DRJIT_CODE_ARENA
+    {
+        std::lock_guard<std::mutex> guard(arena_lock);
+        if (arena_find(ptr) >= 0) {
+            // The code was written through a different virtual address
+            __builtin___clear_cache((char *) ptr, (char *) ptr + size);
+            return;
+        }
+    }
+#endif
+
+#if !defined(_WIN32)
+    if (mprotect(ptr, size, PROT_READ | PROT_EXEC) == -1)
+        jitc_fail("jit_llvm_arena_publish(): mprotect() failed: %s",
+                  strerror(errno));
+#else
+    DWORD unused;
+    if (VirtualProtect(ptr, size, PAGE_EXECUTE_READ, &unused) == 0)
+        jitc_fail("jit_llvm_arena_publish(): VirtualProtect() failed: %u",
+                  GetLastError());
+#endif
+}
+
+void jitc_llvm_arena_free(void *ptr, size_t size) {
+#if DRJIT_CODE_ARENA
+    {
+        std::lock_guard<std::mutex> guard(arena_lock);
+        ptrdiff_t index = arena_find(ptr);
+        if (index >= 0) {
+            CodeChunk &chunk = arena_chunks[index];
+            if (--chunk.live == 0) {
+                if ((size_t) index + 1 == arena_chunks.size() && chunk.rw) {
+                    // Current chunk: rewind and reuse its memory
+                    chunk.offset = 0;
+                } else {
+                    arena_chunk_release(chunk);
+                    arena_chunks.erase(arena_chunks.begin() + index);
+                }
+            }
+            return;
+        }
+    }
+#endif
+
+#if !defined(_WIN32)
+    if (munmap(ptr, size) == -1)
+        jitc_fail("jit_llvm_arena_free(): munmap() failed!");
+#else
+    (void) size;
+    if (VirtualFree(ptr, 0, MEM_RELEASE) == 0)
+        jitc_fail("jit_llvm_arena_free(): VirtualFree() failed!");
+#endif
+}
+
+void jitc_llvm_arena_shutdown() {
+#if DRJIT_CODE_ARENA
+    std::lock_guard<std::mutex> guard(arena_lock);
+    for (CodeChunk &chunk : arena_chunks)
+        arena_chunk_release(chunk);
+    arena_chunks.clear();
+    arena_disabled = false;
+#endif
+}
@@ -0,0 +1,31 @@
+/*
+    src/llvm_arena.h -- Shared executable memory for compiled LLVM kernels
+
+    Copyright (c) 2024 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * \brief Reserve memory for a compiled kernel
+ *
+ * Returns the address from which the kernel will execute, and writes a
+ * writable alias of the same memory region to \c rw. The caller must copy the
+ * machine code via \c rw and then invoke \ref jitc_llvm_arena_publish().
+ */
+extern void *jitc_llvm_arena_alloc(size_t size, size_t align, uint8_t **rw);
+
+/// Make code written via \ref jitc_llvm_arena_alloc() executable
+extern void jitc_llvm_arena_publish(void *ptr, size_t size);
+
+/// Release the memory of a kernel that was evicted from the kernel cache
+extern void jitc_llvm_arena_free(void *ptr, size_t size);
+
+/// Release all remaining arena chunks
+extern void jitc_llvm_arena_shutdown();
@@ -11,12 +11,13 @@
 #  include <windows.h>
 #else
 #  include <dlfcn.h>
-#  include <sys/mman.h>
 #endif
 
 #include "llvm.h"
 #include "llvm_api.h"
 #include "llvm_memmgr.h"
+#include "llvm_arena.h"
+#include "llvm_target.h"
 #include "internal.h"
 #include "log.h"
 #include "var.h"
@@ -60,6 +61,15 @@ char *jitc_llvm_u32_width_str = nullptr;
 /// Current top-level task in the task queue
 Task *jitc_task = nullptr;
 
+/// Thread pool processing high-priority kernels (created on demand)
+Pool *jitc_llvm_pool_high = nullptr;
+
+/// Number of threads of 'jitc_llvm_pool_high' (0: a quarter of the default pool)
+uint32_t jitc_llvm_priority_threads = 0;
+
+/// Task chains of the LLVM thread states with high priority
+std::vector<Task **> jitc_llvm_high_chains;
+
 /// Reference to the target machine used for compilation
 LLVMTargetMachineRef jitc_llvm_tm = nullptr;
 
@@ -69,14 +79,96 @@ uint32_t jitc_llvm_block_size = 16384;
 /// Various hardware capabilities
 bool jitc_llvm_has_avx = false;
 bool jitc_llvm_has_avx512 = false;
+bool jitc_llvm_has_avx512cd = false;
 bool jitc_llvm_has_neon = false;
 
+/// Portable x86-64 microarchitecture level targeted by the backend (0: host CPU)
+uint32_t jitc_llvm_isa_level = 0;
+
+/// Compile kernels for all portable levels following a cache miss?
+bool jitc_llvm_pregenerate = false;
+
+/// Host target description, saved while a portable level is targeted
+static char *jitc_llvm_host_cpu = nullptr;
+static char *jitc_llvm_host_features = nullptr;
+
+/// Features of the x86-64-v3 level (AVX2, FMA) as defined by the x86-64 psABI
+#define DRJIT_X86_64_V3_FEATURES                                               \
+    "+64bit,+avx,+avx2,+bmi,+bmi2,+cmov,+cx16,+cx8,+f16c,+fma,+fxsr,+lzcnt,"  \
+    "+mmx,+movbe,+popcnt,+sahf,+sse,+sse2,+sse3,+sse4.1,+sse4.2,+ssse3,"      \
+    "+xsave"
+
+/// Features of the x86-64-v4 level, which adds AVX-512
+#define DRJIT_X86_64_V4_FEATURES                                               \
+    DRJIT_X86_64_V3_FEATURES ",+avx512bw,+avx512cd,+avx512dq,+avx512f,+avx512vl"
+
 void jitc_llvm_update_strings();
 
-bool jitc_llvm_init() {
-    if (jitc_llvm_init_attempted)
-        return jitc_llvm_init_success;
-    jitc_llvm_init_attempted = true;
+/// Was LLVM loaded and its code generator initialized? (may be deferred)
+static bool jitc_llvm_backend_ready = false;
+
+/// Copy a string allocated by LLVM, so that it can be freed without LLVM
+static char *jitc_llvm_copy_message(char *msg) {
+    char *result = strdup(msg);
+    LLVMDisposeMessage(msg);
+    return result;
+}
+
+/// Release all resources, including partially initialized ones
+static void jitc_llvm_release() {
+    jitc_llvm_memmgr_shutdown();
+    jitc_llvm_arena_shutdown();
+    jitc_llvm_orcv2_shutdown();
+    jitc_llvm_mcjit_shutdown();
+
+    free(jitc_llvm_target_triple);
+    free(jitc_llvm_target_cpu);
+    free(jitc_llvm_target_features);
+    free(jitc_llvm_host_cpu);
+    free(jitc_llvm_host_features);
+    if (jitc_llvm_disasm_ctx) {
+        LLVMDisasmDispose(jitc_llvm_disasm_ctx);
+        jitc_llvm_disasm_ctx = nullptr;
+    }
+
+    jitc_llvm_target_triple = nullptr;
+    jitc_llvm_target_cpu = nullptr;
+    jitc_llvm_target_features = nullptr;
+    jitc_llvm_host_cpu = jitc_llvm_host_features = nullptr;
+    jitc_llvm_isa_level = 0;
+    jitc_llvm_pregenerate = false;
+    jitc_llvm_vector_width = 0;
+    jitc_llvm_context = nullptr;
+    jitc_llvm_has_avx = jitc_llvm_has_avx512 = jitc_llvm_has_neon = false;
+    jitc_llvm_has_avx512cd = false;
+
+    if (jitc_llvm_ones_str) {
+        for (uint32_t i = 0; i < (uint32_t) VarType::Count; ++i)
+            free(jitc_llvm_ones_str[i]);
+        free(jitc_llvm_ones_str);
+    }
+    jitc_llvm_ones_str = nullptr;
+    free(jitc_llvm_u32_arange_str);
+    jitc_llvm_u32_arange_str = nullptr;
+    free(jitc_llvm_u32_width_str);
+    jitc_llvm_u32_width_str = nullptr;
+
+    jitc_llvm_init_success = false;
+    jitc_llvm_init_attempted = false;
+    jitc_llvm_backend_ready = false;
+
+    jitc_llvm_api_shutdown();
+}
+
+/**
+ * Load LLVM and initialize its code generator. The target description is
+ * queried from LLVM unless it was already restored by jitc_llvm_target_load().
+ */
+static bool jitc_llvm_init_backend() {
+    if (jitc_llvm_backend_ready)
+        return true;
+
+    int restored_major = jitc_llvm_target_triple ? jitc_llvm_version_major : -1;
 
     if (!jitc_llvm_api_init())
         return false;
@@ -84,18 +176,15 @@ bool jitc_llvm_init() {
     if (!jitc_llvm_api_has_core()) {
         jitc_log(Warn, "jit_llvm_init(): detected LLVM version lacks core API "
                        "used by Dr.Jit, shutting down LLVM backend ..");
-        jitc_llvm_api_shutdown();
         return false;
     }
 
     if (!jitc_llvm_api_has_pb_new() && !jitc_llvm_api_has_pb_legacy()) {
         jitc_log(Warn, "jit_llvm_init(): detected LLVM version lacks pass "
                        "manager API used by Dr.Jit, shutting down LLVM backend ..");
-        jitc_llvm_api_shutdown();
         return false;
     }
 
-
     LLVMLinkInMCJIT();
     LLVMInitializeDrJitTargetInfo();
     LLVMInitializeDrJitTarget();
@@ -103,9 +192,25 @@ bool jitc_llvm_init() {
     LLVMInitializeDrJitAsmPrinter();
     LLVMInitializeDrJitDisassembler();
 
-    jitc_llvm_target_triple = LLVMGetDefaultTargetTriple();
-    jitc_llvm_target_cpu = LLVMGetHostCPUName();
-    jitc_llvm_target_features = LLVMGetHostCPUFeatures();
+    if (!jitc_llvm_target_triple) {
+        jitc_llvm_target_triple = jitc_llvm_copy_message(LLVMGetDefaultTargetTriple());
+        jitc_llvm_target_cpu = jitc_llvm_copy_message(LLVMGetHostCPUName());
+        jitc_llvm_target_features = jitc_llvm_copy_message(LLVMGetHostCPUFeatures());
+
+#if defined(__APPLE__) && defined(__aarch64__)
+        free(jitc_llvm_target_cpu);
+        jitc_llvm_target_cpu =
+            strdup(jitc_llvm_version_major > 15 ? "apple-m1" : "apple-a14");
+#endif
+    } else if (jitc_llvm_version_major != restored_major) {
+        /* Kernels were already generated for the LLVM version recorded
+           in the stored target description. */
+        jitc_fail("jit_llvm_init(): the loaded LLVM library (version %i) "
+                  "does not match the stored target description (version %i). "
+                  "Please remove the file \"llvm-target.txt\" from the kernel "
+                  "cache directory.", jitc_llvm_version_major, restored_major);
+    }
+
     jitc_llvm_context = LLVMGetGlobalContext();
 
     jitc_llvm_disasm_ctx =
@@ -120,17 +225,25 @@ bool jitc_llvm_init() {
         }
     }
 
-#if !defined(__aarch64__)
-    if (!strstr(jitc_llvm_target_features, "+fma")) {
-        jitc_log(Warn, "jit_llvm_init(): your CPU does not support the `fma` "
-                       "instruction set, shutting down the LLVM "
-                       "backend...");
-        jitc_llvm_shutdown();
+    if (jitc_llvm_api_has_orcv2() && jitc_llvm_orcv2_init()) {
+        jitc_llvm_use_orcv2 = true;
+    } else if (jitc_llvm_api_has_mcjit() && jitc_llvm_mcjit_init()) {
+        jitc_llvm_use_orcv2 = false;
+    } else {
+        jitc_log(Warn, "jit_llvm_init(): ORCv2/MCJIT could not be initialized, "
+                       "shutting down LLVM backend..");
         return false;
     }
-#endif
 
+    jitc_llvm_backend_ready = true;
+    return true;
+}
+
+/// Determine the vector width and ISA extensions from the target features
+static void jitc_llvm_detect_isa() {
     jitc_llvm_vector_width = 1;
+    jitc_llvm_has_avx = jitc_llvm_has_avx512 = jitc_llvm_has_neon = false;
+    jitc_llvm_has_avx512cd = false;
 
     if (strstr(jitc_llvm_target_features, "+sse4.2"))
         jitc_llvm_vector_width = 4;
@@ -141,6 +254,7 @@ bool jitc_llvm_init() {
     if (strstr(jitc_llvm_target_features, "+avx512vl")) {
         jitc_llvm_vector_width = 16;
         jitc_llvm_has_avx512 = true;
+        jitc_llvm_has_avx512cd = strstr(jitc_llvm_target_features, "+avx512cd") != nullptr;
     }
     if (strstr(jitc_llvm_target_features, "+neon")) {
         jitc_llvm_vector_width = 4;
@@ -149,37 +263,55 @@ bool jitc_llvm_init() {
 
 #if defined(__APPLE__) && defined(__aarch64__)
     jitc_llvm_vector_width = 4;
-    LLVMDisposeMessage(jitc_llvm_target_cpu);
-    const char *machine_name = "apple-a14";
-    if (jitc_llvm_version_major > 15)
-        machine_name = "apple-m1";
-    jitc_llvm_target_cpu = LLVMCreateMessage(machine_name);
 #endif
 
-    jitc_llvm_init_success = jitc_llvm_vector_width > 1;
     jitc_llvm_max_align = jitc_llvm_vector_width * 4;
+    jitc_llvm_update_strings();
+}
 
-    if (!jitc_llvm_init_success) {
+/// Check the target features and set up code generation for them
+static bool jitc_llvm_init_target() {
+#if !defined(__aarch64__)
+    if (!strstr(jitc_llvm_target_features, "+fma")) {
+        jitc_log(Warn, "jit_llvm_init(): your CPU does not support the `fma` "
+                       "instruction set, shutting down the LLVM "
+                       "backend...");
+        return false;
+    }
+#endif
+
+    jitc_llvm_detect_isa();
+
+    if (jitc_llvm_vector_width <= 1) {
         jitc_log(Warn,
                  "jit_llvm_init(): no suitable vector ISA found, shutting "
                  "down LLVM backend..");
-        jitc_llvm_shutdown();
+        return false;
     }
 
-    if (jitc_llvm_api_has_orcv2() && jitc_llvm_orcv2_init()) {
-        jitc_llvm_use_orcv2 = true;
-    } else if (jitc_llvm_api_has_mcjit() && jitc_llvm_mcjit_init()) {
-        jitc_llvm_use_orcv2 = false;
-    } else {
-        jitc_log(Warn, "jit_llvm_init(): ORCv2/MCJIT could not be initialized, "
-                       "shutting down LLVM backend..");
-        jitc_llvm_shutdown();
+    jitc_llvm_opaque_pointers = jitc_llvm_version_major >= 15;
+
+    return true;
+}
+
+bool jitc_llvm_init() {
+    if (jitc_llvm_init_attempted)
+        return jitc_llvm_init_success;
+    jitc_llvm_init_attempted = true;
+
+    /* When a previous process stored a matching description of the host
+       target, defer loading LLVM until the first kernel cache miss */
+    bool deferred = jitc_llvm_target_load();
+
+    if ((!deferred && !jitc_llvm_init_backend()) || !jitc_llvm_init_target()) {
+        jitc_llvm_release();
         return false;
     }
 
-    jitc_llvm_opaque_pointers = jitc_llvm_version_major >= 15;
+    if (!deferred)
+        jitc_llvm_target_store();
 
-    jitc_llvm_update_strings();
+    jitc_llvm_init_success = true;
 
     char major_str[5] = "?", minor_str[5] = "?", patch_str[5] = "?";
 
@@ -193,12 +325,12 @@ bool jitc_llvm_init() {
     jitc_log(Info,
              "jit_llvm_init(): found LLVM %s.%s.%s (%s), target=%s, cpu=%s, %s pointers, width=%u.",
              major_str, minor_str, patch_str,
-             jitc_llvm_use_orcv2 ? "ORCv2" : "MCJIT",
+             deferred ? "loaded on demand" : (jitc_llvm_use_orcv2 ? "ORCv2" : "MCJIT"),
              jitc_llvm_target_triple, jitc_llvm_target_cpu,
              jitc_llvm_opaque_pointers ? "opaque" : "typed",
              jitc_llvm_vector_width);
 
-    return jitc_llvm_init_success;
+    return true;
 }
 
 void jitc_llvm_shutdown() {
@@ -207,38 +339,7 @@ void jitc_llvm_shutdown() {
 
     jitc_log(Info, "jit_llvm_shutdown()");
 
-    jitc_llvm_memmgr_shutdown();
-    jitc_llvm_orcv2_shutdown();
-    jitc_llvm_mcjit_shutdown();
-
-    LLVMDisposeMessage(jitc_llvm_target_triple);
-    LLVMDisposeMessage(jitc_llvm_target_cpu);
-    LLVMDisposeMessage(jitc_llvm_target_features);
-    if (jitc_llvm_disasm_ctx) {
-        LLVMDisasmDispose(jitc_llvm_disasm_ctx);
-        jitc_llvm_disasm_ctx = nullptr;
-    }
-
-    jitc_llvm_target_cpu = nullptr;
-    jitc_llvm_target_features = nullptr;
-    jitc_llvm_vector_width = 0;
-    jitc_llvm_context = nullptr;
-
-    if (jitc_llvm_ones_str) {
-        for (uint32_t i = 0; i < (uint32_t) VarType::Count; ++i)
-            free(jitc_llvm_ones_str[i]);
-        free(jitc_llvm_ones_str);
-    }
-    jitc_llvm_ones_str = nullptr;
-    free(jitc_llvm_u32_arange_str);
-    jitc_llvm_u32_arange_str = nullptr;
-    free(jitc_llvm_u32_width_str);
-    jitc_llvm_u32_width_str = nullptr;
-
-    jitc_llvm_init_success = false;
-    jitc_llvm_init_attempted = false;
-
-    jitc_llvm_api_shutdown();
+    jitc_llvm_release();
 }
 
 void jitc_llvm_update_strings() {
@@ -315,26 +416,129 @@ void jitc_llvm_set_target(const char *target_cpu,
     if (!jitc_llvm_init_success)
         return;
 
-    if (jitc_llvm_target_cpu)
-        LLVMDisposeMessage(jitc_llvm_target_cpu);
-
-    if (jitc_llvm_target_features) {
-        LLVMDisposeMessage(jitc_llvm_target_features);
-        jitc_llvm_target_features = nullptr;
-    }
+    free(jitc_llvm_target_cpu);
+    free(jitc_llvm_target_features);
 
     jitc_llvm_vector_width = vector_width;
-    jitc_llvm_target_cpu = LLVMCreateMessage((char *) target_cpu);
-    if (target_features)
-        jitc_llvm_target_features = LLVMCreateMessage((char *) target_features);
+    jitc_llvm_target_cpu = strdup(target_cpu);
+    jitc_llvm_target_features = target_features ? strdup(target_features) : nullptr;
+
+    // An explicitly specified target replaces the portable mode
+    free(jitc_llvm_host_cpu);
+    free(jitc_llvm_host_features);
+    jitc_llvm_host_cpu = jitc_llvm_host_features = nullptr;
+    jitc_llvm_isa_level = 0;
+    jitc_llvm_pregenerate = false;
 
     jitc_llvm_update_strings();
 }
 
+/// Does the comma-separated list 'features' contain all entries of 'required'?
+static bool jitc_llvm_has_features(const char *features, const char *required) {
+    if (!features)
+        return false;
+
+    size_t features_len = strlen(features);
+    while (*required) {
+        const char *end = strchr(required, ',');
+        size_t len = end ? (size_t) (end - required) : strlen(required);
+
+        bool found = false;
+        for (const char *p = features; !found && p < features + features_len; ) {
+            const char *next = strchr(p, ',');
+            size_t len_p = next ? (size_t) (next - p) : strlen(p);
+            found = len_p == len && strncmp(p, required, len) == 0;
+            p += len_p + 1;
+        }
+
+        if (!found)
+            return false;
+
+        required += len + (end ? 1 : 0);
+    }
+
+    return true;
+}
+
+void jitc_llvm_set_isa_level(uint32_t level) {
+    const char *cpu, *features;
+    if (level == 3) {
+        cpu = "x86-64-v3";
+        features = DRJIT_X86_64_V3_FEATURES;
+    } else if (level == 4) {
+        cpu = "x86-64-v4";
+        features = DRJIT_X86_64_V4_FEATURES;
+    } else {
+        cpu = jitc_llvm_host_cpu;
+        features = jitc_llvm_host_features;
+    }
+
+    char *cpu_copy = strdup(cpu),
+         *features_copy = features ? strdup(features) : nullptr;
+
+    free(jitc_llvm_target_cpu);
+    free(jitc_llvm_target_features);
+    jitc_llvm_target_cpu = cpu_copy;
+    jitc_llvm_target_features = features_copy;
+    jitc_llvm_isa_level = level;
+
+    jitc_llvm_detect_isa();
+}
+
+void jitc_llvm_set_portable(uint32_t portable, bool pregenerate) {
+    if (!jitc_llvm_init_success)
+        return;
+
+#if defined(__x86_64__) || defined(_M_X64)
+    const char *host_features = jitc_llvm_isa_level ? jitc_llvm_host_features
+                                                    : jitc_llvm_target_features;
+    uint32_t level = 0;
+
+    if (portable) {
+        if (portable != 3 &&
+            jitc_llvm_has_features(host_features, DRJIT_X86_64_V4_FEATURES))
+            level = 4;
+        else if (jitc_llvm_has_features(host_features, DRJIT_X86_64_V3_FEATURES))
+            level = 3;
+        else
+            jitc_log(Warn, "jit_llvm_set_portable(): the host CPU supports "
+                           "neither x86-64-v3 nor x86-64-v4, generating code "
+                           "for the host CPU instead.");
+    }
+
+    if (level && !jitc_llvm_isa_level) {
+        jitc_llvm_host_cpu = strdup(jitc_llvm_target_cpu);
+        jitc_llvm_host_features = jitc_llvm_target_features
+                                      ? strdup(jitc_llvm_target_features)
+                                      : nullptr;
+    }
+
+    if (level != jitc_llvm_isa_level)
+        jitc_llvm_set_isa_level(level);
+
+    if (!level) {
+        free(jitc_llvm_host_cpu);
+        free(jitc_llvm_host_features);
+        jitc_llvm_host_cpu = jitc_llvm_host_features = nullptr;
+    }
+
+    jitc_llvm_pregenerate = level && pregenerate;
+
+    jitc_log(Info, "jit_llvm_set_portable(): generating code for %s (width=%u%s).",
+             jitc_llvm_target_cpu, jitc_llvm_vector_width,
+             jitc_llvm_pregenerate ? ", pregenerating other levels" : "");
+#else
+    (void) pregenerate;
+    if (portable)
+        jitc_log(Warn, "jit_llvm_set_portable(): portable code generation is "
+                       "only supported on x86-64 platforms.");
+#endif
+}
+
 /// Dump assembly representation
 void jitc_llvm_disasm(const Kernel &kernel) {
     if (std::max(state.log_level_stderr, state.log_level_callback) <
-        LogLevel::Trace)
+            LogLevel::Trace || !jitc_llvm_disasm_ctx)
         return;
 
     for (uint32_t i = 0; i < kernel.llvm.n_reloc; ++i) {
@@ -379,6 +583,14 @@ static ProfilerRegion profiler_region_llvm_compile("jit_llvm_compile");
 void jitc_llvm_compile(Kernel &kernel) {
     ProfilerPhase phase(profiler_region_llvm_compile);
 
+    // LLVM may not have been loaded yet if jitc_llvm_init() deferred this step
+    if (unlikely(!jitc_llvm_backend_ready)) {
+        jitc_log(Info, "jit_llvm_compile(): loading LLVM following a kernel "
+                       "cache miss ..");
+        if (!jitc_llvm_init_backend())
+            jitc_fail("jit_llvm_compile(): LLVM could not be initialized!");
+    }
+
     jitc_llvm_memmgr_prepare(buffer.size());
 
     LLVMMemoryBufferRef llvm_buf = LLVMCreateMemoryBufferWithMemoryRange(
@@ -463,45 +675,31 @@ void jitc_llvm_compile(Kernel &kernel) {
             "following kernel code was responsible for this problem:\n\n%s",
             buffer.get());
 
-#if !defined(_WIN32)
-    void *ptr = mmap(nullptr, jitc_llvm_memmgr_offset, PROT_READ | PROT_WRITE,
-                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    if (ptr == MAP_FAILED)
-        jitc_fail("jit_llvm_compile(): could not mmap() memory: %s",
-                  strerror(errno));
-#else
-    void *ptr = VirtualAlloc(nullptr, jitc_llvm_memmgr_offset,
-                             MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-    if (!ptr)
-        jitc_fail("jit_llvm_compile(): could not VirtualAlloc() memory: %u", GetLastError());
-#endif
-    memcpy(ptr, jitc_llvm_memmgr_data, jitc_llvm_memmgr_offset);
+    uint8_t *rw = nullptr;
+    void *ptr = jitc_llvm_arena_alloc(jitc_llvm_memmgr_offset,
+                                      jitc_llvm_memmgr_align, &rw);
+    memcpy(rw, jitc_llvm_memmgr_data, jitc_llvm_memmgr_offset);
 
     kernel.data = ptr;
     kernel.size = (uint32_t) jitc_llvm_memmgr_offset;
     kernel.llvm.n_reloc = (uint32_t) reloc.size();
     kernel.llvm.reloc = (void **) malloc_check(sizeof(void *) * reloc.size());
+    kernel.llvm.align = jitc_llvm_memmgr_align;
 
     // Relocate function pointers
     for (size_t i = 0; i < reloc.size(); ++i)
         kernel.llvm.reloc[i] = (uint8_t *) ptr + (reloc[i] - jitc_llvm_memmgr_data);
 
-    // Write address of @callables
+    // Write address of @callables (via the writable view of the kernel)
     if (kernel.llvm.n_reloc > 1)
-        *((void **) kernel.llvm.reloc[1]) = kernel.llvm.reloc + 1;
+        *((void **) (rw + (reloc[1] - jitc_llvm_memmgr_data))) =
+            kernel.llvm.reloc + 1;
 
 #if defined(DRJIT_ENABLE_ITTNOTIFY)
     kernel.llvm.itt = __itt_string_handle_create(kernel_name);
 #endif
 
-#if !defined(_WIN32)
-    if (mprotect(ptr, jitc_llvm_memmgr_offset, PROT_READ | PROT_EXEC) == -1)
-        jitc_fail("jit_llvm_compile(): mprotect() failed: %s", strerror(errno));
-#else
-    DWORD unused;
-    if (VirtualProtect(ptr, jitc_llvm_memmgr_offset, PAGE_EXECUTE_READ, &unused) == 0)
-        jitc_fail("jit_llvm_compile(): VirtualProtect() failed: %u", GetLastError());
-#endif
+    jitc_llvm_arena_publish(ptr, jitc_llvm_memmgr_offset);
 }
 
 std::pair<uint32_t, uint32_t> jitc_llvm_expand_replication_factor(uint32_t size, uint32_t tsize) {
@@ -77,6 +77,9 @@
 #include "llvm_array.h"
 #include "llvm_eval.h"
 #include "llvm_packet.h"
+#include "llvm_math.h"
+#include "llvm_search.h"
+#include "llvm_random.h"
 
 // Forward declaration
 static void jitc_llvm_render(Variable *v);
@@ -85,31 +88,64 @@ static void jitc_llvm_render_trace(const Variable *v,
                                    const Variable *func,
                                    const Variable *scene);
 
-void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group) {
-    bool print_labels = std::max(state.log_level_stderr,
-                                 state.log_level_callback) >= LogLevel::Trace ||
-                        (jitc_flags() & (uint32_t) JitFlag::PrintIR);
+/**
+ * Should memory accesses to this variable bypass the cache hierarchy? This is
+ * only beneficial for large streaming arrays. Smaller arrays and values that
+ * a subsequent part of a split kernel reloads should remain cache-resident.
+ */
+static bool jitc_llvm_nontemporal(const Variable *v, uint32_t index) {
+    // See  https://github.com/llvm/llvm-project/issues/102611
+    if ((VarType) v->type == VarType::Float16)
+        return false;
 
-    fmt("define void @drjit_^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^(i64 %start, i64 "
-        "%end, i32 %thread_id, {i8**} noalias %params) #0 ${\n"
-        "entry:\n");
+    if (llvm_nontemporal_threshold == 0)
+        return true;
+
+    return (size_t) v->size * type_size[v->type] >= llvm_nontemporal_threshold &&
+           !split_shared.count(index);
+}
+
+/// Set while rendering the unmasked main loop of a peeled kernel
+static bool llvm_peel_main = false;
+
+/// Name of the loop counter of the kernel body that is being rendered
+static const char *llvm_index = "%index";
 
+/// Largest group, for which the masked remainder is peeled off
+static constexpr uint32_t llvm_peel_max_size = 4096;
+
+/// Minimum number of packets per launch, for which peeling pays off
+static constexpr uint32_t llvm_peel_min_packets = 4;
+
+/**
+ * Should the kernel process full packets in an unmasked main loop, and the
+ * remaining lanes in a separate masked epilogue? This only pays off when the
+ * kernel actually consults the default mask, and when it processes enough
+ * packets for the main loop to dominate. The body is rendered twice, which
+ * restricts this to small groups of operations without internal state.
+ */
+static bool jitc_llvm_peel(ScheduledGroup group) {
+    if (group.end - group.start > llvm_peel_max_size ||
+        group.size < jitc_llvm_vector_width * llvm_peel_min_packets)
+        return false;
+
+    bool has_mask = false;
     for (uint32_t gi = group.start; gi != group.end; ++gi) {
-        uint32_t index = schedule[gi].index;
-        Variable *v = jitc_var(index);
+        const Variable *v = jitc_var(schedule[gi].index);
         VarKind kind = (VarKind) v->kind;
 
-        if (!(kind == VarKind::Array || (kind == VarKind::Evaluated && v->is_array())))
-            break;
+        if (v->is_array() || kind == VarKind::ScatterInc ||
+            (uint32_t) kind >= (uint32_t) VarKind::Call)
+            return false;
 
-        jitc_llvm_render_array(v, v->dep[0] ? jitc_var(v->dep[0]) : nullptr);
+        has_mask |= kind == VarKind::DefaultMask;
     }
 
-    put("    br label %body\n"
-        "\n"
-        "body:\n"
-        "    %index = phi i64 [ %index_next, %suffix ], [ %start, %entry ]\n");
+    return has_mask;
+}
 
+/// Render the body of the kernel's main loop
+static void jitc_llvm_assemble_body(ScheduledGroup group, bool print_labels) {
     for (uint32_t gi = group.start; gi != group.end; ++gi) {
         uint32_t index = schedule[gi].index;
         Variable *v = jitc_var(index);
@@ -144,9 +180,9 @@ void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group) {
 
             // For output parameters and non-scalar inputs
             if (ptype != ParamType::Input || size != 1)
-                fmt( "    $v_p{4|5} = getelementptr inbounds $m, {$m*} $v_p3, i64 %index\n"
+                fmt( "    $v_p{4|5} = getelementptr inbounds $m, {$m*} $v_p3, i64 $s\n"
                     "{    $v_p5 = bitcast $m* $v_p4 to $M*\n|}",
-                    v, v, v, v, v, v, v, v);
+                    v, v, v, v, llvm_index, v, v, v, v);
         }
 
         if (likely(ptype == ParamType::Input)) {
@@ -156,9 +192,8 @@ void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group) {
             if (size != 1) {
                 // Load a packet of values
 
-                // See  https://github.com/llvm/llvm-project/issues/102611
                 const char *nontemporal =
-                    vt == VarType::Float16 ? "" : ", !nontemporal !3";
+                    jitc_llvm_nontemporal(v, index) ? ", !nontemporal !3" : "";
 
                 fmt("    $v$s = load $M, {$M*} $v_p5, align $A, !alias.scope !2$s\n",
                     v, vt == VarType::Bool ? "_0" : "", v, v, v, v, nontemporal);
@@ -201,21 +236,99 @@ void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group) {
                     fmt("    $v_e = zext $V to $M\n", v, v, v);
                     ext = "_e";
                 }
-                fmt("    store $M $v$s, {$M*} $v_p5, align $A, !noalias !2, !nontemporal !3\n",
-                    v, v, ext, v, v, v);
+                const char *nontemporal =
+                    jitc_llvm_nontemporal(v, index) ? ", !nontemporal !3" : "";
+                fmt("    store $M $v$s, {$M*} $v_p5, align $A, !noalias !2$s\n",
+                    v, v, ext, v, v, v, nontemporal);
             } else {
                 jitc_llvm_render_array_memcpy_out(v);
             }
         }
     }
+}
+
+void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group) {
+    bool print_labels = std::max(state.log_level_stderr,
+                                 state.log_level_callback) >= LogLevel::Trace ||
+                        (jitc_flags() & (uint32_t) JitFlag::PrintIR),
+         peel = jitc_llvm_peel(group);
+
+    fmt("define void @drjit_^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^(i64 %start, i64 "
+        "%end, i32 %thread_id, {i8**} noalias %params) #0 ${\n"
+        "entry:\n");
+
+    for (uint32_t gi = group.start; gi != group.end; ++gi) {
+        uint32_t index = schedule[gi].index;
+        Variable *v = jitc_var(index);
+        VarKind kind = (VarKind) v->kind;
+
+        if (!(kind == VarKind::Array || (kind == VarKind::Evaluated && v->is_array())))
+            break;
+
+        jitc_llvm_render_array(v, v->dep[0] ? jitc_var(v->dep[0]) : nullptr);
+    }
+
+    if (!peel) {
+        put("    br label %body\n"
+            "\n"
+            "body:\n"
+            "    %index = phi i64 [ %index_next, %suffix ], [ %start, %entry ]\n");
+
+        jitc_llvm_assemble_body(group, print_labels);
+
+        put("    br label %suffix\n"
+            "\n"
+            "suffix:\n");
+        fmt("    %index_next = add i64 %index, $w\n");
+        put("    %cond = icmp uge i64 %index_next, %end\n"
+            "    br i1 %cond, label %done, label %body, !llvm.loop !4\n\n");
+    } else {
+        /* Process full packets in an unmasked main loop. The remaining
+           lanes are handled by a separate masked copy of the loop body. */
+        fmt("    %n_full_0 = sub i64 %end, %start\n"
+            "    %n_full = and i64 %n_full_0, -$w\n"
+            "    %end_full = add i64 %start, %n_full\n"
+            "    %has_full = icmp ne i64 %n_full, 0\n"
+            "    br i1 %has_full, label %body, label %tail_check\n"
+            "\n"
+            "body:\n"
+            "    %index = phi i64 [ %index_next, %suffix ], [ %start, %entry ]\n");
+
+        llvm_peel_main = true;
+        jitc_llvm_assemble_body(group, print_labels);
+        llvm_peel_main = false;
+
+        put("    br label %suffix\n"
+            "\n"
+            "suffix:\n");
+        fmt("    %index_next = add i64 %index, $w\n");
+        put("    %cond = icmp uge i64 %index_next, %end_full\n"
+            "    br i1 %cond, label %tail_check, label %body, !llvm.loop !4\n\n"
+            "tail_check:\n"
+            "    %has_tail = icmp ult i64 %end_full, %end\n"
+            "    br i1 %has_tail, label %tail, label %done\n"
+            "\n"
+            "tail:\n"
+            "    %index_tail = add i64 %end_full, 0\n");
+
+        // Shift register indices to give the epilogue its own SSA names
+        uint32_t offset = 0;
+        for (uint32_t gi = group.start; gi != group.end; ++gi)
+            offset = std::max(offset, jitc_var(schedule[gi].index)->reg_index + 1);
+        for (uint32_t gi = group.start; gi != group.end; ++gi)
+            jitc_var(schedule[gi].index)->reg_index += offset;
+
+        llvm_index = "%index_tail";
+        jitc_llvm_assemble_body(group, false);
+        llvm_index = "%index";
+
+        for (uint32_t gi = group.start; gi != group.end; ++gi)
+            jitc_var(schedule[gi].index)->reg_index -= offset;
+
+        put("    br label %done\n\n");
+    }
 
-    put("    br label %suffix\n"
-        "\n"
-        "suffix:\n");
-    fmt("    %index_next = add i64 %index, $w\n");
-    put("    %cond = icmp uge i64 %index_next, %end\n"
-        "    br i1 %cond, label %done, label %body, !llvm.loop !4\n\n"
-        "done:\n"
+    put("done:\n"
         "    ret void\n"
         "}\n");
 
@@ -456,6 +569,12 @@ void jitc_llvm_assemble_func(const CallData *call, uint32_t inst) {
 
 static inline bool jitc_fp16_supported_llvm(VarKind kind) {
     switch (kind) {
+        case VarKind::Sin:
+        case VarKind::Cos:
+        case VarKind::Exp2:
+        case VarKind::Log2:
+            return false;
+
         case VarKind::Min:
         case VarKind::Max:
 #if !defined (__aarch64__)
@@ -466,6 +585,128 @@ static inline bool jitc_fp16_supported_llvm(VarKind kind) {
     }
 }
 
+/// Memory access patterns of gathers that index the source with a modular or
+/// affine function of the lane counter (see \ref jitc_llvm_gather_view())
+enum class LLVMGatherView { None, Contiguous, Broadcast, Reversed };
+
+/**
+ * Gathers created by jit_var_tile(), jit_var_repeat(), and jit_var_reverse()
+ * behave like lazy views of the source array. When the consumer is another
+ * gather, their index arithmetic is folded into it by jitc_var_reindex(). When
+ * they are instead consumed by the kernel itself, this function recognizes
+ * the index pattern so that the gather can be replaced by an ordinary vector
+ * load, a broadcast, or a reversed vector load. This relies on packets
+ * starting at a multiple of the vector width, and on the first lane of every
+ * packet being active.
+ */
+static LLVMGatherView jitc_llvm_gather_view(const Variable *v,
+                                            const Variable *index,
+                                            const Variable *mask) {
+    if (callable_depth > 0 || (VarType) v->type == VarType::Bool ||
+        (VarType) index->type != VarType::UInt32 || !index->dep[1])
+        return LLVMGatherView::None;
+
+    bool default_mask = (VarKind) mask->kind == VarKind::DefaultMask,
+         true_mask = mask->is_literal() && mask->literal == 1;
+
+    if (!default_mask && !true_mask)
+        return LLVMGatherView::None;
+
+    const Variable *d0 = jitc_var(index->dep[0]),
+                   *d1 = jitc_var(index->dep[1]);
+
+    uint64_t w = jitc_llvm_vector_width, c = d1->literal;
+    bool counter_lhs = (VarKind) d0->kind == VarKind::Counter &&
+                       d1->is_literal() && c != 0;
+
+    switch ((VarKind) index->kind) {
+        case VarKind::Mod: // jit_var_tile()
+            if (counter_lhs && c % w == 0)
+                return LLVMGatherView::Contiguous;
+            break;
+
+        case VarKind::And: // jit_var_tile() with a power-of-two source size
+            if (counter_lhs && ((c + 1) & c) == 0 && (c + 1) % w == 0)
+                return LLVMGatherView::Contiguous;
+            break;
+
+        case VarKind::Div: // jit_var_repeat()
+            if (counter_lhs && c % w == 0)
+                return LLVMGatherView::Broadcast;
+            break;
+
+        case VarKind::Shr: // jit_var_repeat() with a power-of-two count
+            if (counter_lhs && c < 32 && ((uint64_t) 1 << c) % w == 0)
+                return LLVMGatherView::Broadcast;
+            break;
+
+        case VarKind::Sub: // jit_var_reverse()
+            if (d0->is_literal() && (VarKind) d1->kind == VarKind::Counter &&
+                default_mask)
+                return LLVMGatherView::Reversed;
+            break;
+
+        default:
+            break;
+    }
+
+    return LLVMGatherView::None;
+}
+
+/// Render a gather that was recognized by \ref jitc_llvm_gather_view()
+static void jitc_llvm_render_gather_view(LLVMGatherView view, const Variable *v,
+                                         const Variable *ptr,
+                                         const Variable *index,
+                                         const Variable *mask) {
+    uint32_t width = jitc_llvm_vector_width;
+
+    // Address of the element accessed by the first (or, if reversed, last) lane
+    fmt("    $v_0 = extractelement $V, i32 $u\n"
+        "    $v_1 = sext i32 $v_0 to i64\n"
+        "{    $v_2 = bitcast i8* $v to $t*\n|}"
+        "    $v_3 = getelementptr $t, {$t*} {$v_2|$v}, i64 $v_1\n",
+        v, index, view == LLVMGatherView::Reversed ? width - 1 : 0,
+        v, v,
+        v, ptr, v,
+        v, v, v, v, ptr, v);
+
+    switch (view) {
+        case LLVMGatherView::Contiguous:
+            fmt("{    $v_4 = bitcast $t* $v_3 to $T*\n|}"
+                "    $v = load $T, {$T*} {$v_4|$v_3}, align $a\n",
+                v, v, v, v,
+                v, v, v, v, v, v);
+            break;
+
+        case LLVMGatherView::Broadcast:
+            fmt("    $v_4 = load $t, {$t*} $v_3, align $a\n"
+                "    $v_5 = insertelement $T undef, $t $v_4, i32 0\n"
+                "    $v = shufflevector $T $v_5, $T undef, <$w x i32> $z\n",
+                v, v, v, v, v,
+                v, v, v, v,
+                v, v, v, v);
+            break;
+
+        default:
+            fmt_intrinsic("declare $T @llvm.masked.load.v$w$h.p0{v$w$h|}({$T*}, i32, <$w x i1>, $T)",
+                          v, v, v, v, v);
+
+            fmt("    $v_4 = shufflevector $V, <$w x i1> undef, <$w x i32> <",
+                v, mask);
+            for (uint32_t i = 0; i < width; ++i)
+                fmt("i32 $u$s", width - 1 - i, i + 1 < width ? ", " : ">\n");
+            fmt("{    $v_5 = bitcast $t* $v_3 to $T*\n|}"
+                "    $v_6 = call $T @llvm.masked.load.v$w$h.p0{v$w$h|}({$T*} {$v_5|$v_3}, i32 $a, <$w x i1> $v_4, $T undef)\n"
+                "    $v = shufflevector $T $v_6, $T undef, <$w x i32> <",
+                v, v, v, v,
+                v, v, v, v, v, v, v, v, v, v,
+                v, v, v, v);
+            for (uint32_t i = 0; i < width; ++i)
+                fmt("i32 $u$s", width - 1 - i, i + 1 < width ? ", " : ">\n");
+            break;
+    }
+}
+
 static void jitc_llvm_render(Variable *v) {
     const char *stmt = nullptr;
     Variable *a0 = v->dep[0] ? jitc_var(v->dep[0]) : nullptr,
@@ -535,6 +776,13 @@ static void jitc_llvm_render(Variable *v) {
             fmt("    $v = call $T @llvm.sqrt.v$w$h($V)\n", v, v, v, a0);
             break;
 
+        case VarKind::Sin:
+        case VarKind::Cos:
+        case VarKind::Exp2:
+        case VarKind::Log2:
+            jitc_llvm_render_math(v, a0);
+            break;
+
         case VarKind::RSqrtApprox:
             if (jitc_llvm_has_neon && jitc_llvm_vector_width == 4) {
                 fmt_intrinsic("declare <$w x float> @llvm.aarch64.neon.frsqrte.v4f32(<$w x float>)");
@@ -932,6 +1180,12 @@ static void jitc_llvm_render(Variable *v) {
             break;
 
         case VarKind::Gather: {
+                LLVMGatherView view = jitc_llvm_gather_view(v, a1, a2);
+                if (view != LLVMGatherView::None) {
+                    jitc_llvm_render_gather_view(view, v, a0, a1, a2);
+                    break;
+                }
+
                 bool is_bool = v->type == (uint32_t) VarType::Bool;
                 if (is_bool) // Temporary change
                     v->type = (uint32_t) VarType::UInt8;
@@ -976,6 +1230,14 @@ static void jitc_llvm_render(Variable *v) {
             jitc_llvm_render_scatter_packet(v, a0, a1, a2);
             break;
 
+        case VarKind::SearchSorted:
+            jitc_llvm_render_searchsorted(v, a0, a1, a2);
+            break;
+
+        case VarKind::Philox:
+            jitc_llvm_render_philox(v, a0, a1, a2);
+            break;
+
         case VarKind::BoundsCheck:
             fmt_intrinsic("declare i1 @llvm$e.vector.reduce.or.v$wi1(<$w x i1>)");
             fmt_intrinsic("declare void @llvm.masked.scatter.v$wi32(<$w x i32>, <$w x {i32*}>, i32, <$w x i1>)");
@@ -1016,14 +1278,21 @@ static void jitc_llvm_render(Variable *v) {
             break;
 
         case VarKind::Counter:
-            fmt("    $v_0 = trunc i64 %index to $t\n"
+            fmt("    $v_0 = trunc i64 $s to $t\n"
                 "    $v_1 = insertelement $T undef, $t $v_0, i32 0\n"
                 "    $v_2 = shufflevector $V_1, $T undef, <$w x i32> $z\n"
                 "    $v = add $V_2, $s\n",
-                v, v, v, v, v, v, v, v, v, v, v, jitc_llvm_u32_arange_str);
+                v, llvm_index, v, v, v, v, v, v, v, v, v, v, jitc_llvm_u32_arange_str);
             break;
 
         case VarKind::DefaultMask:
+            if (llvm_peel_main) {
+                // All lanes of the peeled main loop are in range
+                fmt("    $v = or $T $s, zeroinitializer\n", v, v,
+                    jitc_llvm_ones_str[(int) VarType::Bool]);
+                break;
+            }
+
             fmt("    $v_0 = trunc i64 %end to i32\n"
                 "    $v_1 = insertelement <$w x i32> undef, i32 $v_0, i32 0\n"
                 "    $v_2 = shufflevector <$w x i32> $v_1, <$w x i32> undef, <$w x i32> $z\n"
@@ -0,0 +1,545 @@
+/*
+    src/llvm_math.cpp -- Vectorized transcendental functions for the LLVM backend
+
+    The Sin/Cos/Exp2/Log2 nodes are lowered into calls to small polynomial
+    kernels in the spirit of SLEEF. Each kernel is registered once per kernel
+    via the 'globals_map', which keeps the IR of math-heavy programs compact.
+    The node's literal field selects one of two accuracy tiers: an accurate
+    variant (within a few ULP), and a faster variant using lower-degree
+    polynomials that is chosen when JitFlag::FastMath is set at trace time.
+    Both use minimax polynomials. Sin/Cos reduce their argument by pi/2 in
+    double precision (Cody-Waite), and fall back to a Payne-Hanek reduction
+    for |x| >= 2^20, where the former would lose all significant bits.
+
+    Copyright (c) 2024 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#include "eval.h"
+#include "llvm.h"
+#include "var.h"
+#include "llvm_eval.h"
+#include "llvm_math.h"
+#include "log.h"
+#include <cmath>
+
+/// Append a vector constant with all entries set to 'value'
+static void put_splat(const Variable *v, double value) {
+    uint64_t bits;
+    if ((VarType) v->type == VarType::Float32)
+        value = (double) (float) value;
+    memcpy(&bits, &value, sizeof(double));
+
+    uint32_t width = jitc_llvm_vector_width;
+    put('<');
+    for (uint32_t i = 0; i < width; ++i)
+        fmt("$t 0x$Q$s", v, bits, i + 1 < width ? ", " : ">");
+}
+
+/// Append an integer vector constant with all entries set to 'value'
+static void put_splat_int(const Variable *v, uint64_t value) {
+    uint32_t width = jitc_llvm_vector_width;
+    put('<');
+    for (uint32_t i = 0; i < width; ++i)
+        fmt("$b $U$s", v, value, i + 1 < width ? ", " : ">");
+}
+
+/// Append a vector constant of type 'type' with all entries set to 'value'
+static void put_splat_str(const char *type, const char *value) {
+    uint32_t width = jitc_llvm_vector_width;
+    put('<');
+    for (uint32_t i = 0; i < width; ++i)
+        fmt("$s $s$s", type, value, i + 1 < width ? ", " : ">");
+}
+
+/// Append a double precision vector constant with all entries set to 'value'
+static void put_splat_f64(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(double));
+
+    uint32_t width = jitc_llvm_vector_width;
+    put('<');
+    for (uint32_t i = 0; i < width; ++i)
+        fmt("double 0x$Q$s", bits, i + 1 < width ? ", " : ">");
+}
+
+/// Emit '%<name>_0 = c[0] + arg * (c[1] + arg * (...))' using Horner's scheme
+static void put_poly(const Variable *v, const char *name, const char *arg,
+                     const double *c, uint32_t n) {
+    for (uint32_t i = n - 1; i-- > 0; ) {
+        fmt("    %$s_$u = call $T @llvm.fma.v$w$h($T ", name, i, v, v, v);
+        if (i == n - 2)
+            put_splat(v, c[n - 1]);
+        else
+            fmt("%$s_$u", name, i + 1);
+        fmt(", $T %$s, $T ", v, arg, v);
+        put_splat(v, c[i]);
+        put(")\n");
+    }
+}
+
+/// Emit '%<out> = fma(%<a>, <b>, %<c>)', where 'b' is a constant
+static void put_fma_c(const Variable *v, const char *out, const char *a,
+                      double b, const char *c) {
+    fmt("    %$s = call $T @llvm.fma.v$w$h($T %$s, $T ", out, v, v, v, a, v);
+    put_splat(v, b);
+    fmt(", $T %$s)\n", v, c);
+}
+
+/// Emit a binary operation involving a constant second operand
+static void put_op_c(const Variable *v, const char *out, const char *op,
+                     const char *a, double b) {
+    fmt("    %$s = $s $T %$s, ", out, op, v, a);
+    put_splat(v, b);
+    put('\n');
+}
+
+/// Emit an integer operation involving a constant second operand
+static void put_op_int_c(const Variable *v, const char *out, const char *op,
+                         const char *a, uint64_t b) {
+    fmt("    %$s = $s $B %$s, ", out, op, v, a);
+    put_splat_int(v, b);
+    put('\n');
+}
+
+/// Double precision version of put_fma_c()
+static void put_fma_f64(const char *out, const char *a, double b, const char *c) {
+    fmt("    %$s = call <$w x double> @llvm.fma.v$wf64(<$w x double> %$s, "
+        "<$w x double> ", out, a);
+    put_splat_f64(b);
+    fmt(", <$w x double> %$s)\n", c);
+}
+
+/// Emit an operation on vectors of type 'type' with a constant second operand
+static void put_op_str(const char *out, const char *op, const char *type,
+                       const char *a, const char *b) {
+    fmt("    %$s = $s <$w x $s> %$s, ", out, op, type, a);
+    put_splat_str(type, b);
+    put('\n');
+}
+
+// --------------------------------------------------------------------------
+
+static void jitc_llvm_math_exp2(const Variable *v, bool fast) {
+    bool dp = (VarType) v->type == VarType::Float64;
+    uint32_t mant = dp ? 52 : 23, bias = dp ? 1023 : 127;
+
+    // Minimax fits of 2^f for f in [-1/2, 1/2] (relative error, c[0] = 1)
+    static const double c_sp_fast[] = {
+        1.0, 0.693142831325531, 0.24022351205348969, 0.05557400360703468,
+        0.009666282683610916, 0.001112550962716341
+    };
+    static const double c_sp[] = {
+        1.0, 0.6931472420692444, 0.24022652208805084, 0.055503103882074356,
+        0.009617692790925503, 0.0013406643411144614, 0.00015594677824992687
+    };
+    static const double c_dp_fast[] = {
+        1.0, 0.6931471805599516, 0.24022650695910472, 0.05550410866434658,
+        0.009618129107380712, 0.0013333558246480652, 0.00015403530800821137,
+        1.5252647747737911e-05, 1.3215235633678065e-06, 1.02105064509058e-07,
+        7.1117588238337025e-09
+    };
+    static const double c_dp[] = {
+        1.0, 0.6931471805599457, 0.24022650695910097, 0.05550410866479039,
+        0.009618129107607003, 0.0013333558153440133, 0.0001540353044157236,
+        1.5252727385038238e-05, 1.3215442675182759e-06, 1.0180647722118852e-07,
+        7.072570442467681e-09, 4.078062699466225e-10
+    };
+
+    const double *c = dp ? (fast ? c_dp_fast : c_dp) : (fast ? c_sp_fast : c_sp);
+    uint32_t n_coeffs = dp ? (fast ? 11 : 12) : (fast ? 6 : 7);
+
+    // Clamp to a range where the scale factor 2^n underflows/overflows
+    double lo = dp ? -1076.0 : -151.0,
+           hi = dp ?  1025.0 :  129.0;
+
+    put_op_c(v, "lo", "fcmp olt", "x", lo);
+    fmt("    %x_0 = select <$w x i1> %lo, $T ", v);
+    put_splat(v, lo);
+    fmt(", $T %x\n", v);
+    put_op_c(v, "hi", "fcmp ogt", "x_0", hi);
+    fmt("    %x_1 = select <$w x i1> %hi, $T ", v);
+    put_splat(v, hi);
+    fmt(", $T %x_0\n"
+        "    %nan = fcmp uno $T %x, %x\n"
+        "    %x_2 = select <$w x i1> %nan, $T $z, $T %x_1\n"
+        "    %n = call $T @llvm.rint.v$w$h($T %x_2)\n"
+        "    %f = fsub $T %x_2, %n\n",
+        v, v, v, v, v, v, v, v);
+
+    put_poly(v, "p", "f", c, n_coeffs);
+
+    // Scale by 2^n in two steps so that the result may become denormal
+    fmt("    %n_i = fptosi $T %n to $B\n", v, v);
+    put_op_int_c(v, "n_1", "ashr", "n_i", 1);
+    fmt("    %n_2 = sub $B %n_i, %n_1\n", v);
+    put_op_int_c(v, "e_1", "add", "n_1", bias);
+    put_op_int_c(v, "e_2", "add", "n_2", bias);
+    put_op_int_c(v, "s_1i", "shl", "e_1", mant);
+    put_op_int_c(v, "s_2i", "shl", "e_2", mant);
+    fmt("    %s_1 = bitcast $B %s_1i to $T\n"
+        "    %s_2 = bitcast $B %s_2i to $T\n"
+        "    %r_0 = fmul $T %p_0, %s_1\n"
+        "    %r_1 = fmul $T %r_0, %s_2\n"
+        "    %r = select <$w x i1> %nan, $T %x, $T %r_1\n",
+        v, v, v, v, v, v, v, v);
+}
+
+static void jitc_llvm_math_log2(const Variable *v, bool fast) {
+    bool dp = (VarType) v->type == VarType::Float64;
+    uint32_t mant = dp ? 52 : 23, bias = dp ? 1023 : 127;
+
+    /* log2(m) = 2/ln(2) * atanh(t) with t = (m-1)/(m+1), |t| <= 0.172.
+       Minimax fits of 2/ln(2) * atanh(t)/t in t^2 (relative error) */
+    static const double c_sp_fast[] = {
+        2.885390520095825, 0.9615883231163025, 0.5957807302474976
+    };
+    static const double c_sp[] = {
+        2.885390043258667, 0.9617988467216492, 0.5767143964767456,
+        0.43173590302467346
+    };
+    static const double c_dp_fast[] = {
+        2.88539008177785, 0.96179669411331, 0.5770779423761315,
+        0.41220925110620876, 0.31990575329503634, 0.2828993040507302
+    };
+    static const double c_dp[] = {
+        2.8853900817779268, 0.9617966939259899, 0.5770780163454702,
+        0.41219858585110675, 0.3205985339230812, 0.26233440188854784,
+        0.22091186378007802, 0.2136708058012036
+    };
+
+    const double *c = dp ? (fast ? c_dp_fast : c_dp) : (fast ? c_sp_fast : c_sp);
+    uint32_t n_coeffs = dp ? (fast ? 6 : 8) : (fast ? 3 : 4);
+
+    uint32_t denorm_shift = mant + 2;
+    double min_normal = dp ? 0x1p-1022 : 0x1p-126;
+
+    // Normalize denormals, then split into mantissa and exponent
+    put_op_c(v, "small", "fcmp olt", "x", min_normal);
+    put_op_c(v, "x_s", "fmul", "x", std::ldexp(1.0, (int) denorm_shift));
+    fmt("    %x_0 = select <$w x i1> %small, $T %x_s, $T %x\n"
+        "    %bits = bitcast $T %x_0 to $B\n",
+        v, v, v, v);
+    put_op_int_c(v, "e_0", "lshr", "bits", mant);
+    put_op_int_c(v, "m_0", "and", "bits", (uint64_t(1) << mant) - 1);
+    put_op_int_c(v, "m_1", "or", "m_0", uint64_t(bias) << mant);
+    fmt("    %m_2 = bitcast $B %m_1 to $T\n", v, v);
+
+    // Move the mantissa into the range [sqrt(1/2), sqrt(2)]
+    put_op_c(v, "big", "fcmp ogt", "m_2", 1.41421356237309504880);
+    put_op_c(v, "m_3", "fmul", "m_2", 0.5);
+    fmt("    %m = select <$w x i1> %big, $T %m_3, $T %m_2\n"
+        "    %e_1 = zext <$w x i1> %big to $B\n"
+        "    %e_2 = add $B %e_0, %e_1\n",
+        v, v, v, v);
+    put_op_int_c(v, "e_3", "sub", "e_2", bias);
+    fmt("    %e_4 = select <$w x i1> %small, $B ", v);
+    put_splat_int(v, denorm_shift);
+    fmt(", $B $z\n"
+        "    %e_5 = sub $B %e_3, %e_4\n"
+        "    %e = sitofp $B %e_5 to $T\n",
+        v, v, v, v);
+
+    put_op_c(v, "t_0", "fsub", "m", 1.0);
+    put_op_c(v, "t_1", "fadd", "m", 1.0);
+    fmt("    %t = fdiv $T %t_0, %t_1\n"
+        "    %t2 = fmul $T %t, %t\n", v, v);
+    put_poly(v, "p", "t2", c, n_coeffs);
+    fmt("    %l = fmul $T %t, %p_0\n"
+        "    %r_0 = fadd $T %l, %e\n"
+        "    %zero = fcmp oeq $T %x, $z\n"
+        "    %r_1 = select <$w x i1> %zero, $T ",
+        v, v, v, v);
+    put_splat(v, -INFINITY);
+    fmt(", $T %r_0\n"
+        "    %neg = fcmp ult $T %x, $z\n"
+        "    %r_2 = select <$w x i1> %neg, $T ",
+        v, v, v);
+    put_splat(v, NAN);
+    fmt(", $T %r_1\n", v);
+    put_op_c(v, "inf", "fcmp oeq", "x", INFINITY);
+    fmt("    %r = select <$w x i1> %inf, $T %x, $T %r_2\n", v, v);
+}
+
+/* The binary expansion of 2/pi in 64-bit words, preceded by a zero word so
+   that the bit window of the smallest argument passed to rem_pio2() starts
+   within the table */
+static const uint64_t two_over_pi[20] = {
+    0x0000000000000000ull, 0xa2f9836e4e441529ull, 0xfc2757d1f534ddc0ull,
+    0xdb6295993c439041ull, 0xfe5163abdebbc561ull, 0xb7246e3a424dd2e0ull,
+    0x06492eea09d1921cull, 0xfe1deb1cb129a73eull, 0xe88235f52ebb4484ull,
+    0xe99c7026b45f7e41ull, 0x3991d639835339f4ull, 0x9c845f8bbdf9283bull,
+    0x1ff897ffde05980full, 0xef2f118b5a0a6d1full, 0x6d367ecf27cb09b7ull,
+    0x4f463f669e5fea2dull, 0x7527bac7ebe5f17bull, 0x3d0739f78a5292eaull,
+    0x6bfb5fb11f8d5d08ull, 0x56033046fc7b6babull
+};
+
+/**
+ * \brief Register '@rem_pio2_v<width>', a Payne-Hanek reduction of large
+ * double precision arguments by pi/2
+ *
+ * Given finite arguments with |x| >= 2^20, it returns the pair (y, q) with
+ * x = y + q*pi/2 (mod 2*pi), |y| <= pi/4 and |q| <= 3. The reduction
+ * operates on |x| and flips the sign of both results for negative inputs. Writing x as
+ * m*2^e, bits of 2/pi with a weight above 2^(1-e) only contribute multiples
+ * of 4 to x*2/pi and are skipped. The product of the 53-bit mantissa and the
+ * following 192 bits yields the quadrant and a fraction with >120 bits.
+ */
+static void jitc_llvm_math_rem_pio2() {
+    size_t offset = buffer.size();
+    put("@two_over_pi = private unnamed_addr constant [20 x i64] [");
+    for (uint32_t i = 0; i < 20; ++i)
+        fmt("i64 $U$s", two_over_pi[i], i + 1 < 20 ? ", " : "], align 8\n");
+    jitc_register_global(buffer.get() + offset);
+    buffer.rewind_to(offset);
+
+    fmt_intrinsic("declare <$w x i64> @llvm.masked.gather.v$wi64(<$w x "
+                  "{i64*}>, i32, <$w x i1>, <$w x i64>)");
+
+    fmt("define internal fastcc ${<$w x double>, <$w x double>$} "
+        "@rem_pio2_v$w(<$w x double> %x) local_unnamed_addr #0 ${\n"
+        "entry:\n"
+        "    %bits = bitcast <$w x double> %x to <$w x i64>\n");
+    put_op_str("ex_0", "lshr", "i64", "bits", "52");
+    put_op_str("ex", "and", "i64", "ex_0", "2047");
+    put_op_str("m_0", "and", "i64", "bits", "4503599627370495");
+    put_op_str("m", "or", "i64", "m_0", "4503599627370496");
+
+    // Fetch the four table words covering the bit window [g, g + 192)
+    put_op_str("g", "sub", "i64", "ex", "1013");
+    put_op_str("j", "lshr", "i64", "g", "6");
+    put_op_str("sh", "and", "i64", "g", "63");
+    put_op_str("sh_c", "xor", "i64", "sh", "63");
+    fmt("{    %tbl = bitcast [20 x i64]* @two_over_pi to i64*\n|}"
+        "    %p_0 = getelementptr inbounds i64, {i64*} {%tbl|@two_over_pi}, <$w x i64> %j\n");
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (i > 0)
+            fmt("    %p_$u = getelementptr inbounds i64, <$w x {i64*}> %p_$u, i64 1\n",
+                i, i - 1);
+        fmt("    %t_$u = call <$w x i64> @llvm.masked.gather.v$wi64(<$w x {i64*}> %p_$u, i32 8, <$w x i1> ",
+            i, i);
+        put_splat_str("i1", "true");
+        fmt(", <$w x i64> $z)\n");
+    }
+
+    // Shift the window into three words (in two steps, as 'sh' may be zero)
+    for (uint32_t i = 0; i < 3; ++i) {
+        fmt("    %b_$u = lshr <$w x i64> %t_$u, ", i, i + 1);
+        put_splat_str("i64", "1");
+        fmt("\n    %a_$u = shl <$w x i64> %t_$u, %sh\n"
+            "    %c_$u = lshr <$w x i64> %b_$u, %sh_c\n"
+            "    %w_$u = or <$w x i64> %a_$u, %c_$u\n"
+            "    %z_$u = zext <$w x i64> %w_$u to <$w x i128>\n",
+            i, i, i, i, i, i, i, i, i);
+    }
+
+    /* 192-bit product modulo 2^192, split into the upper 128 bits 'hi'
+       (2 integer bits followed by 126 fractional bits) and a lower word */
+    fmt("    %m_w = zext <$w x i64> %m to <$w x i128>\n"
+        "    %u_0 = mul <$w x i128> %m_w, %z_0\n"
+        "    %u_1 = mul <$w x i128> %m_w, %z_1\n"
+        "    %u_2 = mul <$w x i128> %m_w, %z_2\n");
+    put_op_str("h_0", "lshr", "i128", "u_2", "64");
+    put_op_str("h_1", "shl", "i128", "u_0", "64");
+    fmt("    %h_2 = add <$w x i128> %h_0, %u_1\n"
+        "    %hi = add <$w x i128> %h_2, %h_1\n"
+        "    %lo = trunc <$w x i128> %u_2 to <$w x i64>\n");
+
+    // Round to the nearest quadrant, which leaves a signed fraction
+    put_op_str("h_3", "add", "i128", "hi", "42535295865117307932921825928971026432");
+    put_op_str("h_4", "lshr", "i128", "h_3", "126");
+    put_op_str("h_5", "shl", "i128", "h_4", "126");
+    fmt("    %f = sub <$w x i128> %hi, %h_5\n"
+        "    %q_0 = trunc <$w x i128> %h_4 to <$w x i64>\n"
+        "    %q_1 = uitofp <$w x i64> %q_0 to <$w x double>\n"
+        "    %neg = icmp slt <$w x i128> %f, $z\n"
+        "    %lo_n = sub <$w x i64> $z, %lo\n"
+        "    %lo_z = icmp eq <$w x i64> %lo, $z\n"
+        "    %f_c = zext <$w x i1> %lo_z to <$w x i128>\n");
+    put_op_str("f_0", "xor", "i128", "f", "-1");
+    fmt("    %f_1 = add <$w x i128> %f_0, %f_c\n"
+        "    %fa = select <$w x i1> %neg, <$w x i128> %f_1, <$w x i128> %f\n"
+        "    %la = select <$w x i1> %neg, <$w x i64> %lo_n, <$w x i64> %lo\n");
+    put_op_str("fa_0", "lshr", "i128", "fa", "64");
+
+    // Convert the magnitude in 64-bit pieces and scale by pi/2 * 2^-126
+    fmt("    %fa_h = trunc <$w x i128> %fa_0 to <$w x i64>\n"
+        "    %fa_l = trunc <$w x i128> %fa to <$w x i64>\n"
+        "    %d_h = uitofp <$w x i64> %fa_h to <$w x double>\n"
+        "    %d_l = uitofp <$w x i64> %fa_l to <$w x double>\n"
+        "    %d_x = uitofp <$w x i64> %la to <$w x double>\n");
+    put_fma_f64("s_0", "d_h", 0x1p64, "d_l");
+    put_fma_f64("s_1", "d_x", 0x1p-64, "s_0");
+    fmt("    %y_0 = fmul <$w x double> %s_1, ");
+    put_splat_f64(std::ldexp(1.57079632679489661923, -126));
+    fmt("\n    %y_1 = fneg <$w x double> %y_0\n"
+        "    %x_neg = fcmp olt <$w x double> %x, $z\n"
+        "    %flip = xor <$w x i1> %neg, %x_neg\n"
+        "    %y = select <$w x i1> %flip, <$w x double> %y_1, <$w x double> %y_0\n"
+        "    %q_2 = fneg <$w x double> %q_1\n"
+        "    %q = select <$w x i1> %x_neg, <$w x double> %q_2, <$w x double> %q_1\n"
+        "    %r_0 = insertvalue ${<$w x double>, <$w x double>$} undef, <$w x double> %y, 0\n"
+        "    %r = insertvalue ${<$w x double>, <$w x double>$} %r_0, <$w x double> %q, 1\n"
+        "    ret ${<$w x double>, <$w x double>$} %r\n"
+        "$}");
+    jitc_register_global(buffer.get() + offset);
+    buffer.rewind_to(offset);
+}
+
+static void jitc_llvm_math_sincos(const Variable *v, bool fast, bool cos) {
+    bool dp = (VarType) v->type == VarType::Float64;
+
+    /* Minimax fits of sin(r)/r and cos(r) in r^2 for |r| <= pi/4 (relative
+       error, c[0] = 1) */
+    static const double s_sp_fast[] = {
+        1.0, -0.16663390398025513, 0.008163281716406345
+    };
+    static const double s_sp[] = {
+        1.0, -0.16666655242443085, 0.00833216030150652,
+        -0.00019515282474458218
+    };
+    static const double s_dp_fast[] = {
+        1.0, -0.1666666666663035, 0.008333333325077776,
+        -0.00019841263728634929, 2.7555339656593635e-06,
+        -2.4760454574898924e-08
+    };
+    static const double s_dp[] = {
+        1.0, -0.1666666666666663, 0.008333333333322118,
+        -0.00019841269829589544, 2.7557313621387726e-06,
+        -2.5050747763152984e-08, 1.5896230173932965e-10
+    };
+    static const double c_sp_fast[] = {
+        1.0, -0.4999988377094269, 0.041655778884887695,
+        -0.0013591853203251958
+    };
+    static const double c_sp[] = {
+        1.0, -0.5, 0.04166661947965622, -0.001388668199069798,
+        2.4383567506447434e-05
+    };
+    static const double c_dp_fast[] = {
+        1.0, -0.4999999999999941, 0.04166666666648785,
+        -0.0013888888870591664, 2.4801578649342545e-05,
+        -2.755524240787436e-07, 2.063063634796111e-09
+    };
+    static const double c_dp[] = {
+        1.0, -0.5, 0.04166666666666647, -0.0013888888888862,
+        2.480158728409459e-05, -2.7557313117283363e-07,
+        2.087558212611201e-09, -1.1353281208621895e-11
+    };
+
+    const double *cs = dp ? (fast ? s_dp_fast : s_dp) : (fast ? s_sp_fast : s_sp),
+                 *cc = dp ? (fast ? c_dp_fast : c_dp) : (fast ? c_sp_fast : c_sp);
+    uint32_t n_sin = dp ? (fast ? 6 : 7) : (fast ? 3 : 4),
+             n_cos = dp ? (fast ? 7 : 8) : (fast ? 4 : 5);
+
+    fmt_intrinsic("declare <$w x double> @llvm.fma.v$wf64(<$w x double>, "
+                  "<$w x double>, <$w x double>)");
+    fmt_intrinsic("declare <$w x double> @llvm.rint.v$wf64(<$w x double>)");
+    fmt_intrinsic("declare <$w x double> @llvm.fabs.v$wf64(<$w x double>)");
+    fmt_intrinsic("declare i1 @llvm$e.vector.reduce.or.v$wi1(<$w x i1>)");
+    jitc_llvm_math_rem_pio2();
+
+    /* Cody-Waite reduction by pi/2 in double precision (also for single
+       precision arguments). The first two parts of pi/2 have 31 and 32
+       significant bits, hence the products with q are exact for |x| < 2^20.
+       Larger arguments take a slow path based on Payne-Hanek reduction. */
+    const char *xd = dp ? "x" : "xd";
+    if (!dp)
+        fmt("    %xd = fpext $T %x to <$w x double>\n", v);
+    fmt("    %n_0 = fmul <$w x double> %$s, ", xd);
+    put_splat_f64(0.63661977236758134308);
+    fmt("\n    %n = call <$w x double> @llvm.rint.v$wf64(<$w x double> %n_0)\n");
+    put_fma_f64("d_0", "n", -1.57079632673412561417e+00, xd);
+    put_fma_f64("d_1", "n", -6.07710050630396597660e-11, "d_0");
+    put_fma_f64("d_2", "n", -2.02226624879595063154e-21, "d_1");
+    fmt("    %ax = call <$w x double> @llvm.fabs.v$wf64(<$w x double> %$s)\n"
+        "    %big_0 = fcmp oge <$w x double> %ax, ", xd);
+    put_splat_f64(0x1p20);
+    fmt("\n    %big_1 = fcmp one <$w x double> %ax, ");
+    put_splat_f64(INFINITY);
+    fmt("\n    %big = and <$w x i1> %big_0, %big_1\n"
+        "    %any_big = call i1 @llvm$e.vector.reduce.or.v$wi1(<$w x i1> %big)\n"
+        "    br i1 %any_big, label %large, label %reduced\n\n"
+        "large:\n"
+        "    %x_l = select <$w x i1> %big, <$w x double> %$s, <$w x double> ",
+        xd);
+    put_splat_f64(0x1p20);
+    fmt("\n    %yq = call fastcc ${<$w x double>, <$w x double>$} @rem_pio2_v$w(<$w x double> %x_l)\n"
+        "    %d_l = extractvalue ${<$w x double>, <$w x double>$} %yq, 0\n"
+        "    %n_l = extractvalue ${<$w x double>, <$w x double>$} %yq, 1\n"
+        "    %d_3 = select <$w x i1> %big, <$w x double> %d_l, <$w x double> %d_2\n"
+        "    %n_3 = select <$w x i1> %big, <$w x double> %n_l, <$w x double> %n\n"
+        "    br label %reduced\n\n"
+        "reduced:\n"
+        "    %$s = phi <$w x double> [ %d_2, %entry ], [ %d_3, %large ]\n"
+        "    %$s = phi <$w x double> [ %n, %entry ], [ %n_3, %large ]\n",
+        dp ? "y" : "y_d", dp ? "q" : "q_d");
+    if (!dp)
+        fmt("    %y = fptrunc <$w x double> %y_d to $T\n"
+            "    %q = fptrunc <$w x double> %q_d to $T\n", v, v);
+    fmt("    %y2 = fmul $T %y, %y\n", v);
+
+    put_poly(v, "ps", "y2", cs, n_sin);
+    put_poly(v, "pc", "y2", cc, n_cos);
+    fmt("    %s = fmul $T %y, %ps_0\n", v);
+
+    // Quadrant (cos(x) = sin(x + pi/2)), computed without integer overflow
+    if (cos)
+        put_op_c(v, "q_1", "fadd", "q", 1.0);
+    else
+        fmt("    %q_1 = fadd $T %q, $z\n", v);
+    put_op_c(v, "q_2", "fmul", "q_1", 0.25);
+    fmt("    %q_3 = call $T @llvm.floor.v$w$h($T %q_2)\n", v, v, v);
+    put_fma_c(v, "k_0", "q_3", -4.0, "q_1");
+    fmt("    %k_nan = fcmp uno $T %k_0, %k_0\n"
+        "    %k_1 = select <$w x i1> %k_nan, $T $z, $T %k_0\n"
+        "    %k = fptosi $T %k_1 to $B\n",
+        v, v, v, v, v);
+    put_op_int_c(v, "k_odd", "and", "k", 1);
+    put_op_int_c(v, "k_neg", "and", "k", 2);
+    fmt("    %swap = icmp ne $B %k_odd, $z\n"
+        "    %flip = icmp ne $B %k_neg, $z\n"
+        "    %r_2 = select <$w x i1> %swap, $T %pc_0, $T %s\n"
+        "    %r_3 = fneg $T %r_2\n"
+        "    %r = select <$w x i1> %flip, $T %r_3, $T %r_2\n",
+        v, v, v, v, v, v, v);
+}
+
+void jitc_llvm_render_math(const Variable *v, const Variable *a0) {
+    const char *name;
+    switch ((VarKind) v->kind) {
+        case VarKind::Sin:  name = "sin";  break;
+        case VarKind::Cos:  name = "cos";  break;
+        case VarKind::Exp2: name = "exp2"; break;
+        case VarKind::Log2: name = "log2"; break;
+        default: jitc_fail("jitc_llvm_render_math(): unsupported operation!");
+    }
+
+    bool fast = v->literal != 0;
+    const char *tier = fast ? "fast" : "accurate";
+
+    fmt_intrinsic("declare $T @llvm.fma.v$w$h($T, $T, $T)", v, v, v, v, v);
+    fmt_intrinsic("declare $T @llvm.rint.v$w$h($T)", v, v, v);
+    fmt_intrinsic("declare $T @llvm.floor.v$w$h($T)", v, v, v);
+
+    size_t offset = buffer.size();
+    fmt("define internal fastcc $T @$s_$s_v$w$h($T %x) local_unnamed_addr #0 ${\n"
+        "entry:\n",
+        v, name, tier, v, v);
+
+    switch ((VarKind) v->kind) {
+        case VarKind::Sin:  jitc_llvm_math_sincos(v, fast, false); break;
+        case VarKind::Cos:  jitc_llvm_math_sincos(v, fast, true); break;
+        case VarKind::Exp2: jitc_llvm_math_exp2(v, fast); break;
+        default:            jitc_llvm_math_log2(v, fast); break;
+    }
+
+    fmt("    ret $T %r\n"
+        "$}", v);
+    jitc_register_global(buffer.get() + offset);
+    buffer.rewind_to(offset);
+
+    fmt("    $v = call fastcc $T @$s_$s_v$w$h($V)\n", v, v, name, tier, v, a0);
+}
@@ -0,0 +1,13 @@
+/*
+    src/llvm_math.h -- Vectorized transcendental functions for the LLVM backend
+
+    Copyright (c) 2024 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#include "eval.h"
+
+/// Render a Sin/Cos/Exp2/Log2 node by calling a vectorized helper function
+extern void jitc_llvm_render_math(const Variable *v, const Variable *a0);
@@ -11,6 +11,9 @@ bool jitc_llvm_memmgr_got = false;
 /// Current position within 'jitc_llvm_memmgr_data'
 size_t jitc_llvm_memmgr_offset = 0;
 
+/// Largest section alignment requested since 'jitc_llvm_memmgr_prepare()'
+uint32_t jitc_llvm_memmgr_align = 0;
+
 /// Size of the buffer backing 'jitc_llvm_memmgr_data'
 static size_t jitc_llvm_memmgr_size = 0;
 
@@ -30,6 +33,9 @@ uint8_t *jitc_llvm_memmgr_allocate(void * /* opaque */, uintptr_t size,
     if (strncmp(name, ".got", 4) == 0)
         jitc_llvm_memmgr_got = true;
 
+    if (align > jitc_llvm_memmgr_align)
+        jitc_llvm_memmgr_align = align;
+
     size_t offset_align = (jitc_llvm_memmgr_offset + (align - 1)) / align * align;
 
     // Zero-fill including padding region
@@ -77,6 +83,7 @@ void jitc_llvm_memmgr_prepare(size_t size) {
     }
 
     jitc_llvm_memmgr_offset = 0;
+    jitc_llvm_memmgr_align = 0;
 }
 
 void jitc_llvm_memmgr_shutdown() {
@@ -90,6 +97,7 @@ void jitc_llvm_memmgr_shutdown() {
     jitc_llvm_memmgr_size = 0;
     jitc_llvm_memmgr_offset = 0;
     jitc_llvm_memmgr_got = false;
+    jitc_llvm_memmgr_align = 0;
 }
 
 void* jitc_llvm_memmgr_create_context(void *) { return nullptr; }
@@ -11,6 +11,9 @@ extern size_t jitc_llvm_memmgr_offset;
 /// Was a global offset table (GOT) generated?
 extern bool jitc_llvm_memmgr_got;
 
+/// Largest section alignment requested since 'jitc_llvm_memmgr_prepare()'
+extern uint32_t jitc_llvm_memmgr_align;
+
 /// Prepare the LLVM compilation memory manager for IR of a given size
 extern void jitc_llvm_memmgr_prepare(size_t size);
 
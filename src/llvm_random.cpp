@@ -0,0 +1,134 @@
+/*
+    src/llvm_random.cpp -- Counter-based random number generation for the
+    LLVM backend
+
+    The Philox node evaluates the Philox2x32-10 bijection by Salmon et al.
+    ("Parallel random numbers: as easy as 1, 2, 3", SC 2011) on the counter
+    pair (counter, stream) using the 32-bit seed as key. Since the result is
+    a pure function of its inputs, no generator state needs to be loaded or
+    written back, and the output does not depend on how a kernel is split
+    into blocks. The ten rounds are emitted into a helper function that is
+    registered once per kernel via the 'globals_map'.
+
+    Copyright (c) 2024 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#include "eval.h"
+#include "llvm.h"
+#include "var.h"
+#include "llvm_eval.h"
+#include "llvm_random.h"
+#include "log.h"
+
+/// Multiplier and Weyl sequence increment used by Philox2x32
+static constexpr uint32_t philox_m = 0xD256D345u, philox_w = 0x9E3779B9u;
+
+/// Number of rounds
+static constexpr uint32_t philox_rounds = 10;
+
+/// Emit '%<name> = <splat of 'value'>' with the given element type
+static void put_splat(const char *name, const char *type, uint64_t value) {
+    fmt("    %$s_0 = insertelement <$w x $s> undef, $s $U, i32 0\n"
+        "    %$s = shufflevector <$w x $s> %$s_0, <$w x $s> undef, <$w x i32> $z\n",
+        name, type, type, value,
+        name, type, name, type);
+}
+
+void jitc_llvm_render_philox(const Variable *v, const Variable *counter,
+                             const Variable *stream, const Variable *seed) {
+    size_t offset = buffer.size();
+    fmt("define internal fastcc <$w x i64> @philox2x32_10_v$w(<$w x i32> %c0_0, "
+        "<$w x i32> %c1_0, <$w x i32> %k_0) local_unnamed_addr #0 ${\n"
+        "entry:\n");
+
+    put_splat("m", "i64", philox_m);
+    put_splat("w", "i32", philox_w);
+    put_splat("s", "i64", 32);
+
+    for (uint32_t i = 0; i < philox_rounds; ++i) {
+        // (c0, c1) <- (hi(m * c0) ^ k ^ c1, lo(m * c0)), k <- k + w
+        fmt("    %x_$u = zext <$w x i32> %c0_$u to <$w x i64>\n"
+            "    %p_$u = mul <$w x i64> %x_$u, %m\n"
+            "    %h_$u = lshr <$w x i64> %p_$u, %s\n"
+            "    %hi_$u = trunc <$w x i64> %h_$u to <$w x i32>\n"
+            "    %c1_$u = trunc <$w x i64> %p_$u to <$w x i32>\n"
+            "    %t_$u = xor <$w x i32> %hi_$u, %k_$u\n"
+            "    %c0_$u = xor <$w x i32> %t_$u, %c1_$u\n",
+            i, i,
+            i, i,
+            i, i,
+            i, i,
+            i + 1, i,
+            i, i, i,
+            i + 1, i, i);
+        if (i + 1 < philox_rounds)
+            fmt("    %k_$u = add <$w x i32> %k_$u, %w\n", i + 1, i);
+    }
+
+    fmt("    %r_0 = zext <$w x i32> %c0_$u to <$w x i64>\n"
+        "    %r_1 = zext <$w x i32> %c1_$u to <$w x i64>\n"
+        "    %r_2 = shl <$w x i64> %r_1, %s\n"
+        "    %r = or <$w x i64> %r_0, %r_2\n"
+        "    ret <$w x i64> %r\n"
+        "$}",
+        philox_rounds, philox_rounds);
+    jitc_register_global(buffer.get() + offset);
+    buffer.rewind_to(offset);
+
+    fmt("    $v_r = call fastcc <$w x i64> @philox2x32_10_v$w($V, $V, $V)\n",
+        v, counter, stream, seed);
+
+    switch ((VarType) v->type) {
+        case VarType::UInt32:
+            fmt("    $v = trunc <$w x i64> $v_r to $T\n", v, v, v);
+            break;
+
+        case VarType::UInt64:
+            fmt("    $v = or <$w x i64> $v_r, $z\n", v, v);
+            break;
+
+        case VarType::Float32:
+            // Uniformly distributed on [0, 1) with 24 bits of precision
+            fmt("    $v_0 = trunc <$w x i64> $v_r to <$w x i32>\n"
+                "    $v_1 = insertelement <$w x i32> undef, i32 8, i32 0\n"
+                "    $v_2 = shufflevector <$w x i32> $v_1, <$w x i32> undef, <$w x i32> $z\n"
+                "    $v_3 = lshr <$w x i32> $v_0, $v_2\n"
+                "    $v_4 = uitofp <$w x i32> $v_3 to $T\n"
+                "    $v_5 = insertelement $T undef, $t 0x3E70000000000000, i32 0\n"
+                "    $v_6 = shufflevector $T $v_5, $T undef, <$w x i32> $z\n"
+                "    $v = fmul $T $v_4, $v_6\n",
+                v, v,
+                v,
+                v, v,
+                v, v, v,
+                v, v, v,
+                v, v, v,
+                v, v, v, v,
+                v, v, v, v);
+            break;
+
+        case VarType::Float64:
+            // Uniformly distributed on [0, 1) with 53 bits of precision
+            fmt("    $v_1 = insertelement <$w x i64> undef, i64 11, i32 0\n"
+                "    $v_2 = shufflevector <$w x i64> $v_1, <$w x i64> undef, <$w x i32> $z\n"
+                "    $v_3 = lshr <$w x i64> $v_r, $v_2\n"
+                "    $v_4 = uitofp <$w x i64> $v_3 to $T\n"
+                "    $v_5 = insertelement $T undef, $t 0x3CA0000000000000, i32 0\n"
+                "    $v_6 = shufflevector $T $v_5, $T undef, <$w x i32> $z\n"
+                "    $v = fmul $T $v_4, $v_6\n",
+                v,
+                v, v,
+                v, v, v,
+                v, v, v,
+                v, v, v,
+                v, v, v, v,
+                v, v, v, v);
+            break;
+
+        default:
+            jitc_fail("jitc_llvm_render_philox(): unsupported output type!");
+    }
+}
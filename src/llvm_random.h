@@ -0,0 +1,15 @@
+/*
+    src/llvm_random.h -- Counter-based random number generation for the LLVM backend
+
+    Copyright (c) 2024 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#include "eval.h"
+
+/// Render a Philox node by calling a vectorized helper function
+extern void jitc_llvm_render_philox(const Variable *v, const Variable *counter,
+                                    const Variable *stream,
+                                    const Variable *seed);
@@ -504,6 +504,196 @@ static const char *append_reduce_op_noconflict(VarType vt, ReduceOp op, const Va
     return "noconflict"; // variant name
 }
 
+/// Emit helpers that permute the lanes of a 16-wide vector (AVX-512)
+static void append_conflict_permute(uint32_t bits) {
+    if (bits == 32) {
+        fmt_intrinsic("declare <16 x i32> @llvm.x86.avx512.permvar.si.512(<16 x i32>, <16 x i32>)");
+        fmt_intrinsic(
+            "define internal fastcc <16 x i32> @conflict_permute_i32(<16 x i32> %x, <16 x i32> %idx) local_unnamed_addr #0 ${\n"
+            "    %r = call <16 x i32> @llvm.x86.avx512.permvar.si.512(<16 x i32> %x, <16 x i32> %idx)\n"
+            "    ret <16 x i32> %r\n"
+            "$}");
+    } else {
+        // A 16-wide vector of 64-bit values spans two registers
+        fmt_intrinsic("declare <8 x i64> @llvm.x86.avx512.vpermi2var.q.512(<8 x i64>, <8 x i64>, <8 x i64>)");
+        fmt_intrinsic(
+            "define internal fastcc <16 x i64> @conflict_permute_i64(<16 x i64> %x, <16 x i32> %idx) local_unnamed_addr #0 ${\n"
+            "    %lo = shufflevector <16 x i64> %x, <16 x i64> undef, <8 x i32> <i32 0, i32 1, i32 2, i32 3, i32 4, i32 5, i32 6, i32 7>\n"
+            "    %hi = shufflevector <16 x i64> %x, <16 x i64> undef, <8 x i32> <i32 8, i32 9, i32 10, i32 11, i32 12, i32 13, i32 14, i32 15>\n"
+            "    %idx_0 = zext <16 x i32> %idx to <16 x i64>\n"
+            "    %idx_lo = shufflevector <16 x i64> %idx_0, <16 x i64> undef, <8 x i32> <i32 0, i32 1, i32 2, i32 3, i32 4, i32 5, i32 6, i32 7>\n"
+            "    %idx_hi = shufflevector <16 x i64> %idx_0, <16 x i64> undef, <8 x i32> <i32 8, i32 9, i32 10, i32 11, i32 12, i32 13, i32 14, i32 15>\n"
+            "    %r_lo = call <8 x i64> @llvm.x86.avx512.vpermi2var.q.512(<8 x i64> %lo, <8 x i64> %idx_lo, <8 x i64> %hi)\n"
+            "    %r_hi = call <8 x i64> @llvm.x86.avx512.vpermi2var.q.512(<8 x i64> %lo, <8 x i64> %idx_hi, <8 x i64> %hi)\n"
+            "    %r = shufflevector <8 x i64> %r_lo, <8 x i64> %r_hi, <16 x i32> <i32 0, i32 1, i32 2, i32 3, i32 4, i32 5, i32 6, i32 7, i32 8, i32 9, i32 10, i32 11, i32 12, i32 13, i32 14, i32 15>\n"
+            "    ret <16 x i64> %r\n"
+            "$}");
+    }
+}
+
+/// Can 'append_reduce_op_conflict' handle this operation on the current target?
+static bool jitc_llvm_can_reduce_conflict(VarType vt, ReduceOp op) {
+    uint32_t tsize = type_size[(int) vt];
+    return jitc_llvm_has_avx512cd && jitc_llvm_vector_width == 16 &&
+           (tsize == 4 || tsize == 8) && op != ReduceOp::Mul;
+}
+
+/**
+ * Conflict-detection variant of 'append_reduce_op_local'. Instead of visiting
+ * the lanes one at a time, 'vpconflictd' determines the closest preceding lane
+ * targeting the same address (if any). A parallel prefix reduction along these
+ * chains (pointer jumping, one permutation per step) then accumulates the
+ * total of each group of lanes in its last lane, which issues the only
+ * atomic operation for that address.
+ */
+static const char *append_reduce_op_conflict(VarType vt, ReduceOp op, const Variable *v) {
+    uint32_t shiftamt = log2i_ceil(type_size[(int) vt]),
+             bits = type_size[(int) vt] * 8,
+             width = jitc_llvm_vector_width;
+
+    const char *op_name = reduce_op_name[(int) op],
+               *atomicrmw_name = jitc_llvm_atomicrmw_name(vt, op),
+               *tp = type_name_llvm[(int) vt],
+               *tph = type_name_llvm_abbrev[(int) vt];
+
+    bool is_float = jitc_is_float(vt),
+         is_sint = jitc_is_sint(vt);
+
+    // Instruction(s) combining '%acc' with the value '%acc_p' of a preceding lane
+    char combine[256];
+    switch (op) {
+        case ReduceOp::Add:
+        case ReduceOp::And:
+        case ReduceOp::Or:
+            snprintf(combine, sizeof(combine), "%%acc_c = %s <%u x %s> %%acc, %%acc_p",
+                     op == ReduceOp::Add ? (is_float ? "fadd" : "add")
+                                         : reduce_op_name[(int) op],
+                     width, tp);
+            break;
+
+        case ReduceOp::Min:
+        case ReduceOp::Max:
+            if (is_float) {
+                const char *name = op == ReduceOp::Min ? "minnum" : "maxnum";
+                fmt_intrinsic("declare $T @llvm.$s.v$w$h($T, $T)", v, name, v, v, v);
+                snprintf(combine, sizeof(combine),
+                         "%%acc_c = call <%u x %s> @llvm.%s.v%u%s(<%u x %s> "
+                         "%%acc, <%u x %s> %%acc_p)",
+                         width, tp, name, width, tph, width, tp, width, tp);
+            } else {
+                const char *cmp = op == ReduceOp::Min ? (is_sint ? "slt" : "ult")
+                                                      : (is_sint ? "sgt" : "ugt");
+                snprintf(combine, sizeof(combine),
+                         "%%acc_l = icmp %s <%u x %s> %%acc, %%acc_p\n"
+                         "    %%acc_c = select <%u x i1> %%acc_l, <%u x %s> "
+                         "%%acc, <%u x %s> %%acc_p",
+                         cmp, width, tp, width, width, tp, width, tp);
+            }
+            break;
+
+        default:
+            jitc_fail("append_reduce_op_conflict(): unsupported operation!");
+    }
+
+    append_conflict_permute(32);
+    if (bits != 32)
+        append_conflict_permute(bits);
+
+    fmt_intrinsic("declare <$w x i32> @llvm.x86.avx512.conflict.d.512(<$w x i32>)");
+    fmt_intrinsic("declare <$w x i32> @llvm.ctlz.v$wi32(<$w x i32>, i1)");
+    fmt_intrinsic("declare i32 @llvm.cttz.i32(i32, i1)");
+    fmt_intrinsic("declare i32 @llvm$e.vector.reduce.or.v$wi32(<$w x i32>)");
+
+    fmt_intrinsic(
+        "define internal fastcc void @reduce_$s_$h_atomic_conflict($P %ptr, $T %value, i$w %active_in) local_unnamed_addr #0 ${\n"
+        "prelude:\n"
+        "    %active = bitcast i$w %active_in to <$w x i1>\n"
+        "    %shiftamt_0 = insertelement <$w x i64> undef, i64 $u, i64 0\n"
+        "    %shiftamt_1 = shufflevector <$w x i64> %shiftamt_0, <$w x i64> undef, <$w x i32> $z\n"
+        "    %ptrlo_0 = ptrtoint $P %ptr to <$w x i64>\n"
+        "    %ptrlo_1 = lshr <$w x i64> %ptrlo_0, %shiftamt_1\n"
+        "    %ptrlo_2 = trunc <$w x i64> %ptrlo_1 to <$w x i32>\n"
+        "    %conf_0 = call <$w x i32> @llvm.x86.avx512.conflict.d.512(<$w x i32> %ptrlo_2)\n"
+        "    %active_0 = zext i$w %active_in to i32\n"
+        "    %active_1 = insertelement <$w x i32> undef, i32 %active_0, i32 0\n"
+        "    %active_2 = shufflevector <$w x i32> %active_1, <$w x i32> undef, <$w x i32> $z\n"
+        "    %conf_1 = and <$w x i32> %conf_0, %active_2\n"
+        "    %conf_2 = select <$w x i1> %active, <$w x i32> %conf_1, <$w x i32> $z\n"
+        "    %inner_0 = call i32 @llvm$e.vector.reduce.or.v$wi32(<$w x i32> %conf_2)\n"
+        "    %inner_1 = xor i32 %inner_0, -1\n"
+        "    %leaders = and i32 %active_0, %inner_1\n"
+        "    %c31_0 = insertelement <$w x i32> undef, i32 31, i32 0\n"
+        "    %c31_1 = shufflevector <$w x i32> %c31_0, <$w x i32> undef, <$w x i32> $z\n"
+        "    %lanes_0 = insertelement <$w x i32> undef, i32 $u, i32 0\n"
+        "    %lanes_1 = shufflevector <$w x i32> %lanes_0, <$w x i32> undef, <$w x i32> $z\n"
+        "    %lz = call <$w x i32> @llvm.ctlz.v$wi32(<$w x i32> %conf_2, i1 0)\n"
+        "    %pred_0 = sub <$w x i32> %c31_1, %lz\n"
+        "    br label %combine\n\n"
+        ""
+        "combine:\n"
+        "    %acc = phi $T [ %value, %prelude ], [ %acc_next, %combine_body ]\n"
+        "    %pred = phi <$w x i32> [ %pred_0, %prelude ], [ %pred_next, %combine_body ]\n"
+        "    %has_pred = icmp sge <$w x i32> %pred, $z\n"
+        "    %has_pred_0 = bitcast <$w x i1> %has_pred to i$w\n"
+        "    %has_pred_1 = icmp ne i$w %has_pred_0, 0\n"
+        "    br i1 %has_pred_1, label %combine_body, label %scatter\n\n"
+        ""
+        "combine_body:\n"
+        "    %pred_1 = and <$w x i32> %pred, %lanes_1\n"
+        "    %acc_0 = bitcast $T %acc to <$w x i$u>\n"
+        "    %acc_1 = call fastcc <$w x i$u> @conflict_permute_i$u(<$w x i$u> %acc_0, <$w x i32> %pred_1)\n"
+        "    %acc_p = bitcast <$w x i$u> %acc_1 to $T\n"
+        "    $s\n"
+        "    %acc_next = select <$w x i1> %has_pred, $T %acc_c, $T %acc\n"
+        "    %pred_2 = call fastcc <$w x i32> @conflict_permute_i32(<$w x i32> %pred, <$w x i32> %pred_1)\n"
+        "    %pred_next = select <$w x i1> %has_pred, <$w x i32> %pred_2, <$w x i32> %pred\n"
+        "    br label %combine\n\n"
+        ""
+        "scatter:\n"
+        "    %todo = phi i32 [ %leaders, %combine ], [ %todo_next, %scatter_body ]\n"
+        "    %done = icmp eq i32 %todo, 0\n"
+        "    br i1 %done, label %end, label %scatter_body\n\n"
+        ""
+        "scatter_body:\n"
+        "    %index = call i32 @llvm.cttz.i32(i32 %todo, i1 1)\n"
+        "    %bit = shl nuw i32 1, %index\n"
+        "    %todo_next = xor i32 %todo, %bit\n"
+        "    %ptr_i = extractelement $P %ptr, i32 %index\n"
+        "    %acc_i = extractelement $T %acc, i32 %index\n"
+        "    atomicrmw $s $p %ptr_i, $t %acc_i monotonic\n"
+        "    br label %scatter\n\n"
+        ""
+        "end:\n"
+        "    ret void\n"
+        "$}",
+
+        // definition
+        op_name, v, v, v,
+
+        // prelude
+        shiftamt,
+        v,
+        width - 1,
+
+        // combine
+        v,
+
+        // combine_body
+        v, bits,
+        bits, bits, bits,
+        bits, v,
+        combine,
+        v, v,
+
+        // scatter_body
+        v,
+        v,
+        atomicrmw_name, v, v
+    );
+
+    return "atomic_conflict"; // variant name
+}
+
 void jitc_llvm_render_scatter_reduce(const Variable *v,
                                      const Variable *ptr,
                                      const Variable *value,
@@ -529,6 +719,13 @@ void jitc_llvm_render_scatter_reduce(const Variable *v,
             variant = append_reduce_op_noconflict(vt, op, value);
             break;
 
+        case ReduceMode::Conflict:
+            if (jitc_llvm_can_reduce_conflict(vt, op))
+                variant = append_reduce_op_conflict(vt, op, value);
+            else
+                variant = append_reduce_op_local(vt, op, value);
+            break;
+
         default:
             jitc_fail("jitc_llvm_render_scatter_reduce(): unhandled mode (%i)!", (int) mode);
     }
@@ -553,54 +750,61 @@ void jitc_llvm_render_scatter_inc(Variable *v, const Variable *ptr,
         v, v, v, mask);
 
     fmt_intrinsic("declare i32 @llvm.cttz.i32(i32, i1)");
-    fmt_intrinsic("declare i64 @llvm$e.vector.reduce.umax.v$wi64(<$w x i64>)");
-
+    fmt_intrinsic("declare i32 @llvm.ctpop.i32(i32)");
+    fmt_intrinsic("declare <$w x i32> @llvm.ctpop.v$wi32(<$w x i32>)");
+
+    /* Process one group of lanes targeting the same counter per iteration.
+       The offset of each lane within its group is the number of preceding
+       group members, which a vectorized population count of the group mask
+       (restricted to lower lanes) determines at once. The common case of a
+       packet targeting a single counter thus requires one iteration with a
+       single atomic operation. */
     fmt_intrinsic(
         "define internal fastcc <$w x i32> @reduce_inc_u32(<$w x {i32*}> %ptrs_in, <$w x i1> %active_in) local_unnamed_addr #0 ${\n"
         "L0:\n"
-        "    %ptrs_start_0 = select <$w x i1> %active_in, <$w x {i32*}> %ptrs_in, <$w x {i32*}> $z\n"
-        "    %ptrs_start_1 = ptrtoint <$w x {i32*}> %ptrs_start_0 to <$w x i64>\n"
+        "    %ptrs = ptrtoint <$w x {i32*}> %ptrs_in to <$w x i64>\n"
+        "    %active_0 = bitcast <$w x i1> %active_in to i$w\n"
+        "    %active_1 = zext i$w %active_0 to i32\n"
+        "    %ones_0 = insertelement <$w x i32> undef, i32 1, i32 0\n"
+        "    %ones_1 = shufflevector <$w x i32> %ones_0, <$w x i32> undef, <$w x i32> $z\n"
+        "    %lane_bit = shl <$w x i32> %ones_1, $s\n"
+        "    %lane_prefix = sub <$w x i32> %lane_bit, %ones_1\n"
         "    br label %L1\n\n"
+        ""
         "L1:\n"
-        "    %ptrs = phi <$w x i64> [ %ptrs_start_1, %L0 ], [ %ptrs_next, %L4 ]\n"
-        "    %out = phi <$w x i32> [ $z, %L0 ], [ %out_next, %L4 ]\n"
-        "    %ptr = call i64 @llvm$e.vector.reduce.umax.v$wi64(<$w x i64> %ptrs)\n"
-        "    %done = icmp eq i64 %ptr, 0\n"
-        "    br i1 %done, label %L5, label %L2\n\n"
+        "    %todo = phi i32 [ %active_1, %L0 ], [ %todo_next, %L2 ]\n"
+        "    %out = phi <$w x i32> [ $z, %L0 ], [ %out_next, %L2 ]\n"
+        "    %done = icmp eq i32 %todo, 0\n"
+        "    br i1 %done, label %L3, label %L2\n\n"
         ""
         "L2:\n"
+        "    %leader = call i32 @llvm.cttz.i32(i32 %todo, i1 1)\n"
+        "    %ptr = extractelement <$w x i64> %ptrs, i32 %leader\n"
         "    %ptr_b0 = insertelement <$w x i64> undef, i64 %ptr, i32 0\n"
         "    %ptr_b1 = shufflevector <$w x i64> %ptr_b0, <$w x i64> undef, <$w x i32> $z\n"
-        "    %active_v = icmp eq <$w x i64> %ptr_b1, %ptrs\n"
-        "    %active_i0 = bitcast <$w x i1> %active_v to i$w\n"
-        "    %active_i1 = zext i$w %active_i0 to i32\n"
-        "    %ptrs_next = select <$w x i1> %active_v, <$w x i64> $z, <$w x i64> %ptrs\n"
-        "    br label %L3\n\n"
-        ""
-        "L3:\n"
-        "    %active = phi i32 [ %active_i1, %L2 ], [ %active_next, %L3 ]\n"
-        "    %accum = phi i32 [ 0, %L2 ], [ %accum_next, %L3 ]\n"
-        "    %out_2 = phi <$w x i32> [ %out, %L2 ], [ %out_2_next, %L3 ]\n"
-        "    %index = call i32 @llvm.cttz.i32(i32 %active, i1 1)\n"
-        "    %index_bit = shl nuw nsw i32 1, %index\n"
-        "    %active_next = xor i32 %active, %index_bit\n"
-        "    %accum_next = add nuw nsw i32 %accum, 1\n"
-        "    %out_2_next = insertelement <$w x i32> %out_2, i32 %accum, i32 %index\n"
-        "    %done_2 = icmp eq i32 %active_next, 0\n"
-        "    br i1 %done_2, label %L4, label %L3\n\n"
-        ""
-        "L4:\n"
+        "    %match_v = icmp eq <$w x i64> %ptr_b1, %ptrs\n"
+        "    %match_0 = bitcast <$w x i1> %match_v to i$w\n"
+        "    %match_1 = zext i$w %match_0 to i32\n"
+        "    %match = and i32 %match_1, %todo\n"
+        "    %match_b0 = insertelement <$w x i32> undef, i32 %match, i32 0\n"
+        "    %match_b1 = shufflevector <$w x i32> %match_b0, <$w x i32> undef, <$w x i32> $z\n"
+        "    %rank_0 = and <$w x i32> %match_b1, %lane_prefix\n"
+        "    %rank = call <$w x i32> @llvm.ctpop.v$wi32(<$w x i32> %rank_0)\n"
+        "    %count = call i32 @llvm.ctpop.i32(i32 %match)\n"
         "    %ptr_p = inttoptr i64 %ptr to {i32*}\n"
-        "    %prev = atomicrmw add {i32*} %ptr_p, i32 %accum_next monotonic\n"
+        "    %prev = atomicrmw add {i32*} %ptr_p, i32 %count monotonic\n"
         "    %prev_b0 = insertelement <$w x i32> undef, i32 %prev, i32 0\n"
         "    %prev_b1 = shufflevector <$w x i32> %prev_b0, <$w x i32> undef, <$w x i32> $z\n"
-        "    %sum = add <$w x i32> %prev_b1, %out_2_next\n"
-        "    %out_next = select <$w x i1> %active_v, <$w x i32> %sum, <$w x i32> %out\n"
-        "    br label %L1;\n"
+        "    %sum = add <$w x i32> %prev_b1, %rank\n"
+        "    %sel = and <$w x i1> %match_v, %active_in\n"
+        "    %out_next = select <$w x i1> %sel, <$w x i32> %sum, <$w x i32> %out\n"
+        "    %todo_next = xor i32 %todo, %match\n"
+        "    br label %L1\n\n"
         ""
-        "L5:\n"
+        "L3:\n"
         "    ret <$w x i32> %out\n"
-        "$}"
+        "$}",
+        jitc_llvm_u32_arange_str
     );
 
     v->consumed = 1;
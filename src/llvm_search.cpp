@@ -0,0 +1,89 @@
+/*
+    src/llvm_search.cpp -- Vectorized binary search for the LLVM backend
+
+    The SearchSorted node locates the insertion point of each lane's value
+    within an evaluated sorted array. Instead of a loop with data-dependent
+    trip count per lane, the search is lowered into the branch-free variant
+    of 'std::lower_bound' (or 'std::upper_bound'), which halves a shared
+    search range in each step and only advances the per-lane base offset via
+    a 'select'. The number of steps only depends on the array size, which
+    means that all lanes of a packet run in lockstep.
+
+    Copyright (c) 2024 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#include "eval.h"
+#include "llvm.h"
+#include "var.h"
+#include "llvm_eval.h"
+#include "llvm_search.h"
+#include "log.h"
+
+void jitc_llvm_render_searchsorted(const Variable *v, const Variable *ptr,
+                                   const Variable *value,
+                                   const Variable *size) {
+    VarType vt = (VarType) value->type;
+    bool right = v->literal != 0;
+
+    // Predicate determining whether the search range should advance
+    const char *cmp;
+    if (jitc_is_float(vt))
+        cmp = right ? "fcmp ole" : "fcmp olt";
+    else if (jitc_is_sint(vt))
+        cmp = right ? "icmp sle" : "icmp slt";
+    else
+        cmp = right ? "icmp ule" : "icmp ult";
+    const char *pred = cmp + 5;
+
+    fmt_intrinsic("declare $T @llvm.masked.gather.v$w$h($P, i32, <$w x i1>, $T)",
+                  value, value, value, value);
+
+    fmt_intrinsic(
+        "define internal fastcc <$w x i32> @searchsorted_$s_v$w$h($P %ptr, $T %x, <$w x i32> %n_v) local_unnamed_addr #0 ${\n"
+        "entry:\n"
+        "    %n = extractelement <$w x i32> %n_v, i32 0\n"
+        "    %ones_0 = insertelement <$w x i1> undef, i1 1, i32 0\n"
+        "    %ones = shufflevector <$w x i1> %ones_0, <$w x i1> undef, <$w x i32> $z\n"
+        "    br label %loop\n\n"
+        "loop:\n"
+        "    %base = phi <$w x i32> [ $z, %entry ], [ %base_next, %body ]\n"
+        "    %len = phi i32 [ %n, %entry ], [ %len_next, %body ]\n"
+        "    %cont = icmp ugt i32 %len, 1\n"
+        "    br i1 %cont, label %body, label %done\n\n"
+        "body:\n"
+        "    %half = lshr i32 %len, 1\n"
+        "    %half_0 = insertelement <$w x i32> undef, i32 %half, i32 0\n"
+        "    %half_1 = shufflevector <$w x i32> %half_0, <$w x i32> undef, <$w x i32> $z\n"
+        "    %mid = add <$w x i32> %base, %half_1\n"
+        "    %mid_p = getelementptr inbounds $t, $P %ptr, <$w x i32> %mid\n"
+        "    %mid_v = call $T @llvm.masked.gather.v$w$h($P %mid_p, i32 $a, <$w x i1> %ones, $T $z)\n"
+        "    %step = $s $T %mid_v, %x\n"
+        "    %base_next = select <$w x i1> %step, <$w x i32> %mid, <$w x i32> %base\n"
+        "    %len_next = sub i32 %len, %half\n"
+        "    br label %loop\n\n"
+        "done:\n"
+        "    %base_p = getelementptr inbounds $t, $P %ptr, <$w x i32> %base\n"
+        "    %base_v = call $T @llvm.masked.gather.v$w$h($P %base_p, i32 $a, <$w x i1> %ones, $T $z)\n"
+        "    %last = $s $T %base_v, %x\n"
+        "    %last_i = zext <$w x i1> %last to <$w x i32>\n"
+        "    %r = add <$w x i32> %base, %last_i\n"
+        "    ret <$w x i32> %r\n"
+        "$}",
+        pred, value, value, value,
+        value, value,
+        value, value, value, value, value,
+        cmp, value,
+        value, value,
+        value, value, value, value, value,
+        cmp, value);
+
+    fmt("{    $v_0 = bitcast $<i8*$> $v to $<$p$>\n|}"
+         "    $v_1 = getelementptr inbounds $t, $<$p$> {$v_0|$v}, <$w x i32> $z\n"
+         "    $v = call fastcc <$w x i32> @searchsorted_$s_v$w$h($P $v_1, $V, $V)\n",
+        v, ptr, value,
+        v, value, value, v, ptr,
+        v, pred, value, value, v, value, size);
+}
@@ -0,0 +1,285 @@
+/*
+    src/llvm_target.cpp -- Persistent description of the LLVM host target
+
+    Loading libLLVM and initializing its code generator takes a substantial
+    amount of time and memory, while processes with a warm kernel cache
+    never invoke it: cache hits in jitc_kernel_load() only relocate stored
+    machine code. However, the IR used to look up kernels in the cache
+    embeds the target CPU and feature strings reported by LLVM, which
+    cannot be recreated without LLVM.
+
+    Therefore, the first process that initializes LLVM on a machine writes
+    these strings along with the LLVM version to the cache directory. Later
+    processes restore them if a cheap CPUID-based fingerprint of the
+    processor and the identity (path, size, modification time) of the LLVM
+    shared library are unchanged, and defer loading LLVM until the first
+    kernel cache miss.
+
+    Copyright (c) 2024 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#include "llvm_target.h"
+#include "llvm_api.h"
+#include "llvm.h"
+#include "internal.h"
+#include "log.h"
+#include <stdarg.h>
+
+#if !defined(_WIN32)
+#  include <dlfcn.h>
+#  include <unistd.h>
+#  include <sys/stat.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <cpuid.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#  include <sys/auxv.h>
+#  include <asm/hwcap.h>
+#elif defined(__aarch64__) && defined(__APPLE__)
+#  include <sys/sysctl.h>
+#endif
+
+/// Version of the file format below
+#define DRJIT_LLVM_TARGET_VERSION 1
+
+/// Size of the scratch buffers used below
+#define DRJIT_LLVM_TARGET_BUF 512
+
+/// Append formatted output to a zero-terminated string in 'buf'
+static void jitc_llvm_target_append(char *buf, const char *fmt, ...) {
+    size_t len = strlen(buf);
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf + len, DRJIT_LLVM_TARGET_BUF - len, fmt, args);
+    va_end(args);
+}
+
+/// Write a fingerprint of the host processor's ISA extensions to 'buf'
+static bool jitc_llvm_cpu_fingerprint(char *buf) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int max_leaf, a, b, c, d;
+    if (!__get_cpuid(0, &max_leaf, &b, &c, &d))
+        return false;
+    jitc_llvm_target_append(buf, "%08x%08x%08x", b, d, c); // vendor string
+
+    // Processor signature and feature flags (skipping the APIC ID in 'ebx')
+    __get_cpuid(1, &a, &b, &c, &d);
+    jitc_llvm_target_append(buf, " %08x %08x %08x", a, c, d);
+    bool osxsave = (c >> 27) & 1;
+
+    if (max_leaf >= 7) {
+        __get_cpuid_count(7, 0, &a, &b, &c, &d);
+        jitc_llvm_target_append(buf, " %08x %08x %08x", b, c, d);
+    }
+
+    if (__get_cpuid(0x80000001, &a, &b, &c, &d))
+        jitc_llvm_target_append(buf, " %08x %08x", c, d);
+
+    // Register state enabled by the OS (AVX/AVX-512 are unusable otherwise)
+    if (osxsave) {
+        unsigned int xcr0_lo, xcr0_hi;
+        __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+        jitc_llvm_target_append(buf, " %08x%08x", xcr0_hi, xcr0_lo);
+    }
+    return true;
+#elif defined(__aarch64__) && defined(__linux__)
+    unsigned long hwcap = getauxval(AT_HWCAP),
+                  hwcap2 = getauxval(AT_HWCAP2);
+    jitc_llvm_target_append(buf, "%016lx %016lx", hwcap, hwcap2);
+
+    // The kernel emulates MIDR_EL1 reads, which identify the core type
+#if defined(HWCAP_CPUID)
+    if (hwcap & HWCAP_CPUID) {
+        uint64_t midr;
+        __asm__ volatile("mrs %0, MIDR_EL1" : "=r"(midr));
+        jitc_llvm_target_append(buf, " %016llx", (unsigned long long) midr);
+    }
+#endif
+    return true;
+#elif defined(__aarch64__) && defined(__APPLE__)
+    char brand[128];
+    size_t size = sizeof(brand);
+    if (sysctlbyname("machdep.cpu.brand_string", brand, &size, nullptr, 0) != 0)
+        return false;
+    for (char *p = brand; *p; ++p) {
+        if (*p == ' ')
+            *p = '_';
+    }
+    jitc_llvm_target_append(buf, "%s", brand);
+    return true;
+#else
+    (void) buf;
+    return false;
+#endif
+}
+
+/// Write the path of the LLVM shared library to 'buf'
+static bool jitc_llvm_library_path(char *buf) {
+#if !defined(_WIN32)
+    Dl_info info;
+    if (!LLVMGetHostCPUName ||
+        dladdr((void *) LLVMGetHostCPUName, &info) == 0 || !info.dli_fname)
+        return false;
+    jitc_llvm_target_append(buf, "%s", info.dli_fname);
+    return true;
+#else
+    (void) buf;
+    return false;
+#endif
+}
+
+/// Write the size and modification time of the file 'path' to 'buf'
+static bool jitc_llvm_library_stat(const char *path, char *buf) {
+#if !defined(_WIN32)
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return false;
+    jitc_llvm_target_append(buf, "%llu %llu", (unsigned long long) st.st_size,
+                            (unsigned long long) st.st_mtime);
+    return true;
+#else
+    (void) path; (void) buf;
+    return false;
+#endif
+}
+
+#if !defined(_WIN32)
+static void jitc_llvm_target_filename(char *filename, size_t size) {
+    snprintf(filename, size, "%s/llvm-target.txt", jitc_temp_path);
+}
+
+/// Read a line of the form "<key> <value>" and return a copy of the value
+static char *jitc_llvm_target_read(FILE *f, const char *key) {
+    char line[4096];
+    if (!fgets(line, sizeof(line), f))
+        return nullptr;
+
+    size_t len = strlen(line), key_len = strlen(key);
+    if (len == 0 || line[len - 1] != '\n')
+        return nullptr;
+    line[len - 1] = '\0';
+
+    if (strncmp(line, key, key_len) != 0 || line[key_len] != ' ')
+        return nullptr;
+
+    return strdup(line + key_len + 1);
+}
+#endif
+
+bool jitc_llvm_target_load() {
+#if defined(_WIN32)
+    return false;
+#else
+    char filename[512];
+    jitc_llvm_target_filename(filename, sizeof(filename));
+
+    FILE *f = fopen(filename, "r");
+    if (!f)
+        return false;
+
+    const char *keys[] = { "format", "cpuid", "library", "library-stat",
+                           "env", "version", "triple", "cpu", "features" };
+    const size_t n_keys = sizeof(keys) / sizeof(const char *);
+    char *values[n_keys] = { };
+
+    bool success = true;
+    for (size_t i = 0; i < n_keys && success; ++i) {
+        values[i] = jitc_llvm_target_read(f, keys[i]);
+        success = values[i] != nullptr;
+    }
+    fclose(f);
+
+    char buf[DRJIT_LLVM_TARGET_BUF];
+    const char *reason = nullptr;
+
+    if (success) {
+        snprintf(buf, sizeof(buf), "%i", DRJIT_LLVM_TARGET_VERSION);
+        if (strcmp(values[0], buf) != 0)
+            reason = "incompatible format";
+    } else {
+        reason = "truncated file";
+    }
+
+    if (!reason) {
+        buf[0] = '\0';
+        if (!jitc_llvm_cpu_fingerprint(buf) || strcmp(values[1], buf) != 0)
+            reason = "the processor changed";
+    }
+
+    if (!reason) {
+        buf[0] = '\0';
+        if (!jitc_llvm_library_stat(values[2], buf) ||
+            strcmp(values[3], buf) != 0)
+            reason = "the LLVM library changed";
+    }
+
+    if (!reason) {
+        const char *env = getenv("DRJIT_LIBLLVM_PATH");
+        if (strcmp(values[4], env ? env : "") != 0)
+            reason = "DRJIT_LIBLLVM_PATH changed";
+    }
+
+    int major = -1, minor = -1, patch = -1;
+    if (!reason && sscanf(values[5], "%i.%i.%i", &major, &minor, &patch) != 3)
+        reason = "invalid version";
+
+    if (!reason) {
+        jitc_llvm_version_major = major;
+        jitc_llvm_version_minor = minor;
+        jitc_llvm_version_patch = patch;
+        jitc_llvm_target_triple = values[6];
+        jitc_llvm_target_cpu = values[7];
+        jitc_llvm_target_features = values[8];
+        values[6] = values[7] = values[8] = nullptr;
+    } else {
+        jitc_log(Debug, "jit_llvm_init(): ignoring stored target description "
+                        "\"%s\" (%s).", filename, reason);
+    }
+
+    for (size_t i = 0; i < n_keys; ++i)
+        free(values[i]);
+
+    return reason == nullptr;
+#endif
+}
+
+void jitc_llvm_target_store() {
+#if !defined(_WIN32)
+    char cpuid[DRJIT_LLVM_TARGET_BUF] = "", path[DRJIT_LLVM_TARGET_BUF] = "",
+         path_stat[DRJIT_LLVM_TARGET_BUF] = "";
+    if (!jitc_llvm_cpu_fingerprint(cpuid) || !jitc_llvm_library_path(path) ||
+        !jitc_llvm_library_stat(path, path_stat))
+        return;
+
+    char filename[512], filename_tmp[530];
+    jitc_llvm_target_filename(filename, sizeof(filename));
+    snprintf(filename_tmp, sizeof(filename_tmp), "%s.%u.tmp", filename,
+             (unsigned) getpid());
+
+    FILE *f = fopen(filename_tmp, "w");
+    if (!f)
+        return;
+
+    const char *env = getenv("DRJIT_LIBLLVM_PATH");
+    fprintf(f,
+            "format %i\ncpuid %s\nlibrary %s\nlibrary-stat %s\nenv %s\n"
+            "version %i.%i.%i\ntriple %s\ncpu %s\nfeatures %s\n",
+            DRJIT_LLVM_TARGET_VERSION, cpuid, path,
+            path_stat, env ? env : "", jitc_llvm_version_major,
+            jitc_llvm_version_minor, jitc_llvm_version_patch,
+            jitc_llvm_target_triple, jitc_llvm_target_cpu,
+            jitc_llvm_target_features ? jitc_llvm_target_features : "");
+
+    bool success = fclose(f) == 0;
+
+    // Atomically replace the previous description (if any)
+    if (!success || rename(filename_tmp, filename) != 0) {
+        jitc_log(Warn, "jit_llvm_init(): could not write \"%s\"!", filename);
+        unlink(filename_tmp);
+    }
+#endif
+}
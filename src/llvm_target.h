@@ -0,0 +1,25 @@
+/*
+    src/llvm_target.h -- Persistent description of the LLVM host target
+
+    Copyright (c) 2024 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#pragma once
+
+/**
+ * \brief Try to restore the LLVM target description stored by an earlier
+ * process on the same machine.
+ *
+ * On success, this function sets \c jitc_llvm_target_triple, \c
+ * jitc_llvm_target_cpu, \c jitc_llvm_target_features, and the LLVM version
+ * number without loading LLVM. This only happens when a CPUID-based
+ * fingerprint of the processor and the identity of the LLVM shared library
+ * match the stored values.
+ */
+extern bool jitc_llvm_target_load();
+
+/// Store the current LLVM target description for use by future processes
+extern void jitc_llvm_target_store();
@@ -6,21 +6,59 @@
 #include "profile.h"
 #include "util.h"
 #include "llvm_red.h"
+#include <algorithm>
+#include <atomic>
+
+/// Scratch space for llvm_parents()
+static std::vector<const Task *> llvm_parents_tmp;
+
+/**
+ * Return the parents of a task submitted by 'ts': the tail of its own task
+ * chain and, in the case of a normal-priority thread state, the tails of all
+ * high-priority chains. Normal-priority work therefore never starts before
+ * high-priority work that was submitted earlier (see \ref
+ * jitc_llvm_set_priority()).
+ */
+static const Task *const *llvm_parents(const ThreadStateBase *ts,
+                                       uint32_t &count) {
+    if (ts->priority == JitPriority::High || jitc_llvm_high_chains.empty()) {
+        count = 1;
+        return ts->task;
+    }
+
+    llvm_parents_tmp.clear();
+    llvm_parents_tmp.push_back(*ts->task);
+    for (Task **chain : jitc_llvm_high_chains) {
+        if (*chain)
+            llvm_parents_tmp.push_back(*chain);
+    }
+    count = (uint32_t) llvm_parents_tmp.size();
+    return llvm_parents_tmp.data();
+}
 
-/// Helper function: enqueue parallel CPU task (synchronous or asynchronous)
+/// Helper function: enqueue parallel CPU task (synchronous or asynchronous).
+/// Like kernels, the work units skip their work once jit_cancel() was called.
 template <typename Func>
-static void submit_cpu(KernelType type, Func &&func, uint32_t width,
-                       uint32_t size = 1) {
+static void submit_cpu(ThreadStateBase *ts, KernelType type, Func &&func,
+                       uint32_t width, uint32_t size = 1) {
 
-    struct Payload { Func f; };
-    Payload payload{ std::forward<Func>(func) };
+    struct Payload { std::atomic<bool> *cancelled; Func f; };
+    Payload payload{ ts->cancelled, std::forward<Func>(func) };
 
     static_assert(std::is_trivially_copyable<Payload>::value &&
                   std::is_trivially_destructible<Payload>::value, "Internal error!");
 
+    uint32_t parent_count;
+    const Task *const *parents = llvm_parents(ts, parent_count);
+
     Task *new_task = task_submit_dep(
-        nullptr, &jitc_task, 1, size,
-        [](uint32_t index, void *payload) { ((Payload *) payload)->f(index); },
+        ts->pool, parents, parent_count, size,
+        [](uint32_t index, void *ptr) {
+            Payload *payload = (Payload *) ptr;
+            if (!payload->cancelled ||
+                !payload->cancelled->load(std::memory_order_relaxed))
+                payload->f(index);
+        },
         &payload, sizeof(Payload), nullptr, 0);
 
     if (unlikely(jit_flag(JitFlag::LaunchBlocking))) {
@@ -40,36 +78,207 @@ static void submit_cpu(KernelType type, Func &&func, uint32_t width,
         state.kernel_history.append(entry);
     }
 
-    task_release(jitc_task);
-    jitc_task = new_task;
+    task_release(*ts->task);
+    *ts->task = new_task;
 }
 
-/// Temporary scratch space for scheduled tasks
-static std::vector<Task *> scheduled_tasks;
-
 void LLVMThreadState::barrier() {
-    // All tasks in 'scheduled_tasks' have 'jitc_task' (if present) as parent.
-    // To create a barrier, we release 'jitc_task' and initialize it with a new
-    // dummy task that has all members of 'scheduled_tasks' as parents. This
-    // allows groups of kernel launches to run in parallel, while serializing
+    // All tasks in 'scheduled_tasks' have the tail of the task chain (if
+    // present) as parent. This is normally the shared 'jitc_task'. To create
+    // a barrier, we release the tail and initialize it with a new dummy task
+    // that has all members of 'scheduled_tasks' as parents. This allows
+    // groups of kernel launches to run in parallel, while serializing
     // subsequent groups.
+    //
+    // Another thread may have advanced the chain in the meantime, since the
+    // central lock is released while compiling kernels. In that case, its
+    // current tail must become an additional parent.
+
+    jitc_assert(!scheduled_tasks.empty(), "jit_eval(): no tasks generated!");
+    Task *&tail = *task;
 
-    if (scheduled_tasks.size() == 1) {
-        task_release(jitc_task);
-        jitc_task = scheduled_tasks[0];
+    if (scheduled_tasks.size() == 1 && tail == scheduled_parent) {
+        task_release(tail);
+        tail = scheduled_tasks[0];
     } else {
-        jitc_assert(!scheduled_tasks.empty(),
-                    "jit_eval(): no tasks generated!");
+        if (tail != scheduled_parent && tail)
+            scheduled_tasks.push_back(tail);
+        else
+            task_release(tail);
 
         // Insert a barrier task
-        Task *new_task = task_submit_dep(nullptr, scheduled_tasks.data(),
+        Task *new_task = task_submit_dep(pool, scheduled_tasks.data(),
                                          (uint32_t) scheduled_tasks.size());
-        task_release(jitc_task);
         for (Task *t : scheduled_tasks)
             task_release(t);
-        jitc_task = new_task;
+        tail = new_task;
     }
     scheduled_tasks.clear();
+    task_release(scheduled_parent);
+    scheduled_parent = nullptr;
+}
+
+/// Free lists of kernel parameter arrays, indexed by log2(capacity)
+static struct LLVMParamsArena {
+    Lock lock;
+    std::vector<LLVMParams *> free_list[32];
+
+    LLVMParamsArena() { lock_init(lock); }
+    ~LLVMParamsArena() {
+        for (std::vector<LLVMParams *> &list : free_list)
+            for (LLVMParams *params : list)
+                free(params);
+        lock_destroy(lock);
+    }
+} llvm_params_arena;
+
+/// Fetch a parameter array with space for 'size' entries from the arena
+static LLVMParams *llvm_params_alloc(uint32_t size) {
+    uint32_t bucket = log2i_ceil(std::max(size, 16u));
+    LLVMParams *params = nullptr;
+
+    {
+        lock_guard guard(llvm_params_arena.lock);
+        std::vector<LLVMParams *> &list = llvm_params_arena.free_list[bucket];
+        if (!list.empty()) {
+            params = list.back();
+            list.pop_back();
+        }
+    }
+
+    if (!params) {
+        params = (LLVMParams *) malloc_check(sizeof(LLVMParams) +
+                                             (sizeof(void *) << bucket));
+        params->bucket = bucket;
+    }
+
+    params->refs.store(1, std::memory_order_relaxed);
+    params->size = size;
+    return params;
+}
+
+/// Release a reference to a parameter array (may run on a worker thread)
+static void llvm_params_release(LLVMParams *params) {
+    if (!params || params->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+    lock_guard guard(llvm_params_arena.lock);
+    llvm_params_arena.free_list[params->bucket].push_back(params);
+}
+
+/**
+ * Number of work units of high-priority kernels that are currently running.
+ * Work units only start once the dependencies of their task are complete,
+ * hence kernels that are still blocked on earlier work do not count.
+ * Normal-priority work units that observe a nonzero value are deferred
+ * (see \ref LLVMDeferred).
+ */
+static std::atomic<uint32_t> llvm_high_running { 0 };
+
+/**
+ * Payload of a normal-priority kernel launch that takes place while
+ * high-priority thread states exist. Work units that start while
+ * high-priority work is running skip their block and mark it in 'deferred',
+ * which releases the worker thread right away. A second task queued behind
+ * the first one then processes the marked blocks.
+ */
+struct LLVMDeferred {
+    /// Reference count (held by both tasks)
+    std::atomic<uint32_t> refs;
+
+    /// Kernel parameters (holds a reference)
+    LLVMParams *params;
+
+    /// Per-block flags, the entries are stored right after this header
+    uint8_t *deferred() { return (uint8_t *) (this + 1); }
+};
+
+/// Process one block of an LLVM kernel
+static void llvm_run_block(uint32_t index, void **params) {
+    LLVMKernelFunction kernel = (LLVMKernelFunction) params[0];
+    uint32_t size       = (uint32_t) (uintptr_t) params[1],
+             block_size = (uint32_t) ((uintptr_t) params[1] >> 32),
+             start      = index * block_size,
+             thread_id  = pool_thread_id(),
+             end        = std::min(start + block_size, size);
+
+    if (start >= end)
+        return;
+
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+    // Signal start of kernel
+    __itt_task_begin(drjit_domain, __itt_null, __itt_null,
+                     (__itt_string_handle *) params[2]);
+#endif
+    // Perform the main computation
+    kernel(start, end, thread_id, params);
+
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+    // Signal termination of kernel
+    __itt_task_end(drjit_domain);
+#endif
+}
+
+/**
+ * Process one work unit of a kernel launch. The payload starts with the
+ * cancellation flag of the thread state. It is followed by the kernel
+ * parameters, or, in the case of a pipelined launch (see \ref
+ * LLVMThreadState::pipeline()), by the number of stages and a sequence of
+ * [parameter count, parameters..] records. Work unit 'i' then processes
+ * block 'i' of each stage in sequence.
+ */
+template <bool High, bool Pipelined>
+static void llvm_work_unit(uint32_t index, void *ptr) {
+    void **payload = (void **) ptr;
+
+    if (High)
+        llvm_high_running.fetch_add(1, std::memory_order_relaxed);
+
+    if (!((std::atomic<bool> *) payload[0])->load(std::memory_order_relaxed)) {
+        if (Pipelined) {
+            uintptr_t n_stages = (uintptr_t) payload[1];
+            void **stage = payload + 2;
+            for (uintptr_t i = 0; i < n_stages; ++i) {
+                llvm_run_block(index, stage + 1);
+                stage += (uintptr_t) stage[0] + 1;
+            }
+        } else {
+            llvm_run_block(index, payload + 1);
+        }
+    }
+
+    if (High)
+        llvm_high_running.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/// First pass of a deferrable launch: skip blocks while high-priority work runs
+template <bool Pipelined>
+static void llvm_work_unit_deferrable(uint32_t index, void *ptr) {
+    LLVMDeferred *d = (LLVMDeferred *) ptr;
+    if (llvm_high_running.load(std::memory_order_relaxed))
+        d->deferred()[index] = 1;
+    else
+        llvm_work_unit<false, Pipelined>(index, d->params->data());
+}
+
+/// Second pass of a deferrable launch: process the skipped blocks
+template <bool Pipelined>
+static void llvm_work_unit_deferred(uint32_t index, void *ptr) {
+    LLVMDeferred *d = (LLVMDeferred *) ptr;
+    if (d->deferred()[index])
+        llvm_work_unit<false, Pipelined>(index, d->params->data());
+}
+
+static void llvm_deferred_release(void *ptr) {
+    LLVMDeferred *d = (LLVMDeferred *) ptr;
+    if (d->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+    llvm_params_release(d->params);
+    free(d);
+}
+
+bool LLVMThreadState::pipeline() {
+    pipeline_next = true;
+    return true;
 }
 
 Task *
@@ -116,32 +325,6 @@ LLVMThreadState::launch(Kernel kernel, KernelKey * /*key*/,
         blocks = (size + block_size - 1) / block_size;
     }
 
-    auto callback = [](uint32_t index, void *ptr) {
-        void **params = (void **) ptr;
-        LLVMKernelFunction kernel = (LLVMKernelFunction) params[0];
-        uint32_t size       = (uint32_t) (uintptr_t) params[1],
-                 block_size = (uint32_t) ((uintptr_t) params[1] >> 32),
-                 start      = index * block_size,
-                 thread_id  = pool_thread_id(),
-                 end        = std::min(start + block_size, size);
-
-        if (start >= end)
-            return;
-
-#if defined(DRJIT_ENABLE_ITTNOTIFY)
-        // Signal start of kernel
-        __itt_task_begin(drjit_domain, __itt_null, __itt_null,
-                         (__itt_string_handle *) params[2]);
-#endif
-        // Perform the main computation
-        kernel(start, end, thread_id, params);
-
-#if defined(DRJIT_ENABLE_ITTNOTIFY)
-        // Signal termination of kernel
-        __itt_task_end(drjit_domain);
-#endif
-    };
-
     (*kernel_params)[0] = (void *) kernel.llvm.reloc[0];
     (*kernel_params)[1] = (void *) ((((uintptr_t) block_size) << 32) +
                                  (uintptr_t) size);
@@ -154,20 +337,178 @@ LLVMThreadState::launch(Kernel kernel, KernelKey * /*key*/,
                packets, packet_size, packets == 1 ? "" : "s", blocks,
                blocks == 1 ? "" : "s", block_size);
 
-    ret_task = task_submit_dep(
-        nullptr, &jitc_task, 1, blocks,
-        callback, kernel_params->data(),
-        (uint32_t) (kernel_params->size() * sizeof(void *)),
-        nullptr
-    );
+    // Kernels of a pipelined launch are collected and submitted as a single
+    // task once the last stage is known
+    if (pipeline_next || pipeline_stages) {
+        if (!pipeline_stages) {
+            pipeline_payload.clear();
+            pipeline_payload.push_back((void *) cancelled);
+            pipeline_payload.push_back(nullptr);
+            pipeline_blocks = blocks;
+        }
+
+        jitc_assert(blocks == pipeline_blocks,
+                    "LLVMThreadState::launch(): pipelined kernels must have "
+                    "a matching block decomposition!");
+
+        pipeline_payload.push_back((void *) (uintptr_t) kernel_params->size());
+        pipeline_payload.insert(pipeline_payload.end(), kernel_params->begin(),
+                                kernel_params->end());
+        pipeline_stages++;
+
+        bool last = !pipeline_next;
+        pipeline_next = false;
+        if (!last)
+            return nullptr;
+
+        jitc_log(Debug, "jit_run(): submitting %u pipelined kernels.",
+                 pipeline_stages);
+
+        pipeline_payload[1] = (void *) (uintptr_t) pipeline_stages;
+        pipeline_stages = 0;
+
+        LLVMParams *params = llvm_params_alloc((uint32_t) pipeline_payload.size());
+        memcpy(params->data(), pipeline_payload.data(),
+               pipeline_payload.size() * sizeof(void *));
+        ret_task = submit(blocks, params, true);
+    } else {
+        // Kernels that are launched repeatedly with the same parameters (e.g.,
+        // when replaying a frozen function) share the previous payload
+        uint32_t n = (uint32_t) kernel_params->size() + 1;
+        LLVMParams *params = params_last;
+
+        if (!params || params->size != n ||
+            params->data()[0] != (void *) cancelled ||
+            memcmp(params->data() + 1, kernel_params->data(),
+                   (n - 1) * sizeof(void *)) != 0) {
+            llvm_params_release(params_last);
+            params = params_last = llvm_params_alloc(n);
+
+            // Prepend the cancellation flag to the task payload
+            params->data()[0] = (void *) cancelled;
+            memcpy(params->data() + 1, kernel_params->data(),
+                   (n - 1) * sizeof(void *));
+        }
+
+        params->refs.fetch_add(1, std::memory_order_relaxed);
+        ret_task = submit(blocks, params, false);
+    }
 
     if (unlikely(jit_flag(JitFlag::LaunchBlocking)))
         task_wait(ret_task);
 
+    if (scheduled_tasks.empty()) {
+        scheduled_parent = *task;
+        if (scheduled_parent)
+            task_retain(scheduled_parent);
+    }
     scheduled_tasks.push_back(ret_task);
     return ret_task;
 }
 
+Task *LLVMThreadState::submit(uint32_t blocks, LLVMParams *params,
+                              bool pipelined) {
+    uint32_t parent_count;
+    const Task *const *parents = llvm_parents(this, parent_count);
+
+    if (priority == JitPriority::Normal && !jitc_llvm_high_chains.empty()) {
+        /* Normal-priority work units must not occupy worker threads while
+           high-priority kernels run. Those starting at such a time are
+           re-queued in a second task, see \ref LLVMDeferred */
+        LLVMDeferred *d =
+            (LLVMDeferred *) malloc_check(sizeof(LLVMDeferred) + blocks);
+        d->refs.store(2, std::memory_order_relaxed);
+        d->params = params;
+        memset(d->deferred(), 0, blocks);
+
+        Task *first = task_submit_dep(
+            pool, parents, parent_count, blocks,
+            pipelined ? llvm_work_unit_deferrable<true>
+                      : llvm_work_unit_deferrable<false>,
+            d, 0, llvm_deferred_release);
+
+        Task *second = task_submit_dep(
+            pool, &first, 1, blocks,
+            pipelined ? llvm_work_unit_deferred<true>
+                      : llvm_work_unit_deferred<false>,
+            d, 0, llvm_deferred_release);
+
+        task_release(first);
+        return second;
+    }
+
+    void (*callback)(uint32_t, void *);
+    if (priority == JitPriority::High) {
+        callback = pipelined ? llvm_work_unit<true, true>
+                             : llvm_work_unit<true, false>;
+    } else {
+        callback = pipelined ? llvm_work_unit<false, true>
+                             : llvm_work_unit<false, false>;
+    }
+
+    // Pass the payload by reference, the task releases it when done
+    return task_submit_dep(
+        pool, parents, parent_count, blocks, callback, params->data(), 0,
+        [](void *payload) { llvm_params_release((LLVMParams *) payload - 1); });
+}
+
+LLVMThreadState::~LLVMThreadState() {
+    llvm_params_release(params_last);
+}
+
+uint32_t jitc_llvm_priority_thread_count() {
+    if (jitc_llvm_pool_high)
+        return pool_size(jitc_llvm_pool_high);
+    else if (jitc_llvm_priority_threads)
+        return jitc_llvm_priority_threads;
+    else
+        return std::max(1u, pool_size() / 4);
+}
+
+void jitc_llvm_set_priority_thread_count(uint32_t size) {
+    jitc_llvm_priority_threads = size;
+    if (jitc_llvm_pool_high)
+        pool_set_size(jitc_llvm_pool_high,
+                      size ? size : std::max(1u, pool_size() / 4));
+}
+
+void jitc_llvm_set_priority(JitPriority priority) {
+    if (jitc_flags() & (uint32_t) JitFlag::FreezingScope)
+        jitc_raise("jit_llvm_set_priority(): the priority cannot be changed "
+                   "while recording a frozen function!");
+
+    ThreadState *ts_base = thread_state(JitBackend::LLVM);
+    jitc_assert(ts_base->backend == JitBackend::LLVM,
+                "jit_llvm_set_priority(): expected an LLVM thread state!");
+    LLVMThreadState *ts = (LLVMThreadState *) ts_base;
+
+    if (ts->priority == priority)
+        return;
+
+    // Wait for pending work. When switching away from the shared task chain,
+    // this also ensures that no kernel of another thread still accesses
+    // memory that this thread may subsequently reuse.
+    jitc_sync_thread(ts);
+
+    if (priority == JitPriority::High) {
+        if (!jitc_llvm_pool_high)
+            jitc_llvm_pool_high = pool_create(jitc_llvm_priority_thread_count());
+        ts->pool = jitc_llvm_pool_high;
+        ts->task = &ts->task_private;
+        jitc_llvm_high_chains.push_back(&ts->task_private);
+    } else {
+        ts->pool = nullptr;
+        ts->task = &jitc_task;
+        jitc_llvm_high_chains.erase(
+            std::find(jitc_llvm_high_chains.begin(),
+                      jitc_llvm_high_chains.end(), &ts->task_private));
+    }
+
+    jitc_log(Debug, "jit_llvm_set_priority(): switching to %s priority.",
+             priority == JitPriority::High ? "high" : "normal");
+    ts->priority = priority;
+}
+
 void LLVMThreadState::memset_async(void *ptr, uint32_t size_, uint32_t isize,
                                    const void *src){
     if (isize != 1 && isize != 2 && isize != 4 && isize != 8)
@@ -193,7 +534,7 @@ void LLVMThreadState::memset_async(void *ptr, uint32_t size_, uint32_t isize,
     uint8_t src8[8] { };
     std::memcpy(&src8, src, isize);
 
-    submit_cpu(KernelType::Other,
+    submit_cpu(this, KernelType::Other,
         [ptr, src8, size, isize](uint32_t) {
             switch (isize) {
                 case 1:
@@ -302,7 +643,7 @@ void LLVMThreadState::block_reduce(VarType vt, ReduceOp op, uint32_t size,
     }
 
     submit_cpu(
-        KernelType::Reduce,
+        this, KernelType::Reduce,
         [red, work_unit_size, size, block_size, chunk_size, chunk_count, chunks_per_block, in, buf](uint32_t index) {
             red(index, work_unit_size, size, block_size, chunk_size, chunk_count, chunks_per_block, in, buf);
         },
@@ -386,7 +727,7 @@ void LLVMThreadState::block_prefix_reduce(VarType vt, ReduceOp op,
                  work_unit_size > 1 ? "" : "", chunks_per_block);
 
         submit_cpu(
-            KernelType::Reduce,
+            this, KernelType::Reduce,
             [red_1, work_unit_size, size, block_size, chunk_size, chunk_count,
              chunks_per_block, in, scratch](uint32_t index) {
                 red_1(index, work_unit_size, size, block_size, chunk_size,
@@ -409,7 +750,7 @@ void LLVMThreadState::block_prefix_reduce(VarType vt, ReduceOp op,
              work_unit_size > 1 ? "s" : "");
 
     submit_cpu(
-        KernelType::Reduce,
+        this, KernelType::Reduce,
         [red_2, work_unit_size, size, block_size, chunk_size, chunk_count,
          chunks_per_block, exclusive, reverse, in, scratch,
          out](uint32_t index) {
@@ -430,7 +771,7 @@ void LLVMThreadState::poke(void *dst, const void *src, uint32_t size) {
     std::memcpy(&src8, src, size);
 
     submit_cpu(
-        KernelType::Other,
+        this, KernelType::Other,
         [src8, size, dst](uint32_t) {
             std::memcpy(dst, &src8, size);
         },
@@ -461,7 +802,7 @@ void LLVMThreadState::reduce_dot(VarType type, const void *ptr_1,
 
     Reduction2 reduction = jitc_reduce_dot_create(type);
     submit_cpu(
-        KernelType::Reduce,
+        this, KernelType::Reduce,
         [block_size, size, tsize, ptr_1, ptr_2, reduction, target](uint32_t index) {
             reduction(ptr_1, ptr_2, index * block_size,
                       std::min((index + 1) * block_size, size),
@@ -502,7 +843,7 @@ uint32_t LLVMThreadState::compress(const uint8_t *in, uint32_t size,
                                            blocks * sizeof(uint32_t));
 
         submit_cpu(
-            KernelType::Other,
+            this, KernelType::Other,
             [block_size, size, in, scratch](uint32_t index) {
                 uint32_t start = index * block_size,
                          end = std::min(start + block_size, size);
@@ -522,7 +863,7 @@ uint32_t LLVMThreadState::compress(const uint8_t *in, uint32_t size,
     }
 
     submit_cpu(
-        KernelType::Other,
+        this, KernelType::Other,
         [block_size, size, scratch, in, out, &count_out](uint32_t index) {
             uint32_t start = index * block_size,
                      end = std::min(start + block_size, size);
@@ -547,6 +888,7 @@ uint32_t LLVMThreadState::compress(const uint8_t *in, uint32_t size,
 
     jitc_free(scratch);
     jitc_sync_thread();
+    jitc_check_cancelled();
 
     return count_out;
 }
@@ -588,7 +930,7 @@ uint32_t LLVMThreadState::mkperm(const uint32_t *ptr, uint32_t size,
 
     // Phase 1
     submit_cpu(
-        KernelType::CallReduce,
+        this, KernelType::CallReduce,
         [block_size, size, buckets, bucket_count, ptr](uint32_t index) {
             ProfilerPhase profiler(profiler_region_mkperm_phase_1);
             uint32_t start = index * block_size,
@@ -609,7 +951,7 @@ uint32_t LLVMThreadState::mkperm(const uint32_t *ptr, uint32_t size,
 
     // Local accumulation step
     submit_cpu(
-        KernelType::CallReduce,
+        this, KernelType::CallReduce,
         [bucket_count, blocks, buckets, offsets, &unique_count](uint32_t) {
             uint32_t sum = 0, unique_count_local = 0;
             for (uint32_t i = 0; i < bucket_count; ++i) {
@@ -637,12 +979,12 @@ uint32_t LLVMThreadState::mkperm(const uint32_t *ptr, uint32_t size,
         size
     );
 
-    Task *local_task = jitc_task;
+    Task *local_task = *task;
     task_retain(local_task);
 
     // Phase 2
     submit_cpu(
-        KernelType::CallReduce,
+        this, KernelType::CallReduce,
         [block_size, size, buckets, perm, ptr](uint32_t index) {
             ProfilerPhase profiler(profiler_region_mkperm_phase_2);
 
@@ -670,13 +1012,368 @@ uint32_t LLVMThreadState::mkperm(const uint32_t *ptr, uint32_t size,
     return unique_count;
 }
 
+static ProfilerRegion profiler_region_sort_histogram("jit_sort_histogram");
+static ProfilerRegion profiler_region_sort_scatter("jit_sort_scatter");
+
+/// State shared by the tasks of a parallel radix sort, followed by histograms
+struct RadixSortState {
+    /// Current location of the keys/values, and targets of the active pass
+    const void *keys_cur, *keys_src;
+    const uint32_t *values_cur, *values_src;
+    void *keys_dst;
+    uint32_t *values_dst;
+
+    /// Number of passes that were not skipped so far
+    uint32_t executed;
+
+    /// Should the active pass be skipped? (all keys have the same digit)
+    bool skip;
+
+    uint32_t *hist() { return (uint32_t *) (this + 1); }
+};
+
+/// Map keys onto unsigned integers with the same ordering
+template <typename UInt, int Mode> static inline UInt radix_key(UInt k) {
+    constexpr UInt sign = UInt(1) << (sizeof(UInt) * 8 - 1);
+    if constexpr (Mode == 1) // signed integers
+        return k ^ sign;
+    else if constexpr (Mode == 2) // floating point values
+        return (k & sign) ? (UInt) ~k : (UInt) (k | sign);
+    else
+        return k;
+}
+
+/// Stable LSD radix sort processing 8 bits per pass
+template <typename UInt, int Mode>
+static void llvm_radix_sort(ThreadStateBase *ts, uint32_t size,
+                            const void *keys_in, const uint32_t *values_in,
+                            void *keys_out, uint32_t *values_out) {
+    uint32_t blocks = 1, block_size = size, pool_size = ::pool_size();
+
+    if (pool_size > 1) {
+        // Spread out uniformly over cores, but don't make the blocks too small
+        blocks = pool_size * 4;
+        block_size = (size + blocks - 1) / blocks;
+        block_size = std::max(jitc_llvm_block_size, block_size);
+        blocks = (size + block_size - 1) / block_size;
+    }
+
+    jitc_log(Debug,
+             "jit_sort(" DRJIT_PTR " -> " DRJIT_PTR
+             ", size=%u, values=%i, block_size=%u, blocks=%u)",
+             (uintptr_t) keys_in, (uintptr_t) keys_out, size,
+             values_in ? 1 : 0, block_size, blocks);
+
+    RadixSortState *rs = (RadixSortState *) jitc_malloc(
+        AllocType::HostAsync,
+        sizeof(RadixSortState) + sizeof(uint32_t) * 256 * (size_t) blocks);
+
+    UInt *keys_tmp = (UInt *) jitc_malloc(AllocType::HostAsync,
+                                          sizeof(UInt) * (size_t) size);
+    uint32_t *values_tmp = nullptr;
+    if (values_in)
+        values_tmp = (uint32_t *) jitc_malloc(AllocType::HostAsync,
+                                              sizeof(uint32_t) * (size_t) size);
+
+    // Alternate between the output and a temporary buffer. The first pass
+    // must not write to an input that is also an output.
+    bool in_place = keys_in == keys_out || (values_in && values_in == values_out);
+    void *keys_dst[2] = { keys_out, keys_tmp };
+    uint32_t *values_dst[2] = { values_out, values_tmp };
+    if (in_place) {
+        std::swap(keys_dst[0], keys_dst[1]);
+        std::swap(values_dst[0], values_dst[1]);
+    }
+
+    for (uint32_t pass = 0; pass < sizeof(UInt); ++pass) {
+        uint32_t shift = pass * 8;
+
+        // Phase 1: per-block digit histograms
+        submit_cpu(
+            ts, KernelType::Other,
+            [rs, size, block_size, shift, pass, keys_in, values_in](uint32_t index) {
+                ProfilerPhase profiler(profiler_region_sort_histogram);
+
+                if (pass == 0 && index == 0) {
+                    rs->keys_cur = keys_in;
+                    rs->values_cur = values_in;
+                    rs->executed = 0;
+                }
+
+                uint32_t start = index * block_size,
+                         end = std::min(start + block_size, size),
+                         *hist = rs->hist() + index * 256;
+
+                const UInt *keys = (const UInt *) (pass == 0 ? keys_in : rs->keys_cur);
+
+                memset(hist, 0, sizeof(uint32_t) * 256);
+                for (uint32_t i = start; i != end; ++i)
+                    hist[(radix_key<UInt, Mode>(keys[i]) >> shift) & 0xFF]++;
+            },
+            size, blocks);
+
+        // Phase 2: exclusive scan over digits and blocks
+        submit_cpu(
+            ts, KernelType::Other,
+            [rs, size, blocks, keys_dst, values_dst](uint32_t) {
+                uint32_t *hist = rs->hist();
+
+                for (uint32_t d = 0; d < 256; ++d) {
+                    uint32_t total = 0;
+                    for (uint32_t b = 0; b < blocks; ++b)
+                        total += hist[b * 256 + d];
+                    if (total == size) {
+                        rs->skip = true;
+                        return;
+                    } else if (total) {
+                        break;
+                    }
+                }
+
+                uint32_t sum = 0;
+                for (uint32_t d = 0; d < 256; ++d) {
+                    for (uint32_t b = 0; b < blocks; ++b) {
+                        uint32_t value = hist[b * 256 + d];
+                        hist[b * 256 + d] = sum;
+                        sum += value;
+                    }
+                }
+
+                uint32_t target = rs->executed++ % 2;
+                rs->skip = false;
+                rs->keys_src = rs->keys_cur;
+                rs->values_src = rs->values_cur;
+                rs->keys_dst = keys_dst[target];
+                rs->values_dst = values_dst[target];
+                rs->keys_cur = rs->keys_dst;
+                rs->values_cur = rs->values_dst;
+            },
+            size);
+
+        // Phase 3: stable scatter into the target buffer
+        submit_cpu(
+            ts, KernelType::Other,
+            [rs, size, block_size, shift](uint32_t index) {
+                if (rs->skip)
+                    return;
+
+                ProfilerPhase profiler(profiler_region_sort_scatter);
+
+                uint32_t start = index * block_size,
+                         end = std::min(start + block_size, size),
+                         *offset = rs->hist() + index * 256;
+
+                const UInt *keys_src = (const UInt *) rs->keys_src;
+                UInt *keys_dst = (UInt *) rs->keys_dst;
+                const uint32_t *values_src = rs->values_src;
+                uint32_t *values_dst = rs->values_dst;
+
+                for (uint32_t i = start; i != end; ++i) {
+                    UInt key = keys_src[i];
+                    uint32_t j = offset[(radix_key<UInt, Mode>(key) >> shift) & 0xFF]++;
+                    keys_dst[j] = key;
+                    if (values_src)
+                        values_dst[j] = values_src[i];
+                }
+            },
+            size, blocks);
+    }
+
+    // Move the result into the output buffers if necessary
+    submit_cpu(
+        ts, KernelType::Other,
+        [rs, size, keys_out, values_out](uint32_t) {
+            if (rs->keys_cur != keys_out)
+                std::memmove(keys_out, rs->keys_cur, sizeof(UInt) * (size_t) size);
+            if (rs->values_cur && rs->values_cur != values_out)
+                std::memmove(values_out, rs->values_cur,
+                             sizeof(uint32_t) * (size_t) size);
+        },
+        size);
+
+    // Free memory (happens asynchronously after the above stmts.)
+    jitc_free(keys_tmp);
+    jitc_free(values_tmp);
+    jitc_free(rs);
+}
+
+void LLVMThreadState::sort(VarType vt, uint32_t size, const void *keys_in,
+                           const uint32_t *values_in, void *keys_out,
+                           uint32_t *values_out) {
+    if (size == 0)
+        return;
+
+    switch (vt) {
+        case VarType::UInt32:
+            llvm_radix_sort<uint32_t, 0>(this, size, keys_in, values_in, keys_out, values_out);
+            break;
+        case VarType::Int32:
+            llvm_radix_sort<uint32_t, 1>(this, size, keys_in, values_in, keys_out, values_out);
+            break;
+        case VarType::Float32:
+            llvm_radix_sort<uint32_t, 2>(this, size, keys_in, values_in, keys_out, values_out);
+            break;
+        case VarType::UInt64:
+            llvm_radix_sort<uint64_t, 0>(this, size, keys_in, values_in, keys_out, values_out);
+            break;
+        case VarType::Int64:
+            llvm_radix_sort<uint64_t, 1>(this, size, keys_in, values_in, keys_out, values_out);
+            break;
+        case VarType::Float64:
+            llvm_radix_sort<uint64_t, 2>(this, size, keys_in, values_in, keys_out, values_out);
+            break;
+        default:
+            jitc_raise("jit_sort(): unsupported key type \"%s\"!",
+                       type_name[(int) vt]);
+    }
+}
+
+static ProfilerRegion profiler_region_histogram_phase_1("jit_histogram_phase_1");
+static ProfilerRegion profiler_region_histogram_phase_2("jit_histogram_phase_2");
+
+/// Histogram with privatized per-block bins that are merged via a tree reduction
+template <typename T>
+static void llvm_histogram(ThreadStateBase *ts, uint32_t size,
+                           const uint32_t *values, const T *weights,
+                           uint32_t bin_count, T *out) {
+    // Private histograms start on separate cache lines to avoid false sharing
+    constexpr size_t line = 64 / sizeof(T);
+    size_t stride = ((size_t) bin_count + line - 1) / line * line;
+
+    uint32_t blocks = 1, block_size = size, pool_size = ::pool_size();
+
+    if (pool_size > 1) {
+        // One private histogram per worker, within a fixed memory budget
+        size_t budget = ((size_t) 64 << 20) / (stride * sizeof(T));
+        blocks = (uint32_t) std::max((size_t) 1, std::min((size_t) pool_size, budget));
+        block_size = (size + blocks - 1) / blocks;
+
+        // But don't make the blocks too small
+        block_size = std::max(jitc_llvm_block_size, block_size);
+        blocks = (size + block_size - 1) / block_size;
+    }
+
+    jitc_log(Debug,
+             "jit_histogram(" DRJIT_PTR " -> " DRJIT_PTR
+             ", size=%u, bin_count=%u, weights=%i, block_size=%u, blocks=%u)",
+             (uintptr_t) values, (uintptr_t) out, size, bin_count,
+             weights ? 1 : 0, block_size, blocks);
+
+    // The first block accumulates directly into the output array
+    T *priv = nullptr;
+    if (blocks > 1)
+        priv = (T *) jitc_malloc(AllocType::HostAsync,
+                                 sizeof(T) * stride * (blocks - 1));
+
+    // Phase 1: per-block histograms
+    submit_cpu(
+        ts, KernelType::Other,
+        [size, block_size, values, weights, bin_count, out, priv, stride](uint32_t index) {
+            ProfilerPhase profiler(profiler_region_histogram_phase_1);
+
+            uint32_t start = index * block_size,
+                     end = std::min(start + block_size, size);
+
+            T *hist = index == 0 ? out : priv + (index - 1) * stride;
+            memset(hist, 0, sizeof(T) * bin_count);
+
+            if (weights) {
+                for (uint32_t i = start; i != end; ++i) {
+                    uint32_t bin = values[i];
+                    if (bin < bin_count)
+                        hist[bin] += weights[i];
+                }
+            } else {
+                for (uint32_t i = start; i != end; ++i) {
+                    uint32_t bin = values[i];
+                    if (bin < bin_count)
+                        hist[bin] += T(1);
+                }
+            }
+        },
+        size, blocks);
+
+    /* Phase 2: merge the private histograms using a tree reduction. Each
+       step adds histogram 'i + step' into 'i' for all indices 'i' divisible
+       by '2 * step', and large histograms are further split into chunks. */
+    uint32_t chunk_size = 16384,
+             chunks = (bin_count + chunk_size - 1) / chunk_size;
+
+    for (uint32_t step = 1; step < blocks; step *= 2) {
+        uint32_t pairs = (blocks - step + 2 * step - 1) / (2 * step);
+
+        submit_cpu(
+            ts, KernelType::Other,
+            [bin_count, out, priv, stride, step, chunks, chunk_size](uint32_t index) {
+                ProfilerPhase profiler(profiler_region_histogram_phase_2);
+
+                uint32_t pair = index / chunks, chunk = index % chunks,
+                         dst_index = pair * 2 * step,
+                         src_index = dst_index + step,
+                         start = chunk * chunk_size,
+                         end = std::min(start + chunk_size, bin_count);
+
+                T *dst = dst_index == 0 ? out : priv + (dst_index - 1) * stride;
+                const T *src = priv + (src_index - 1) * stride;
+
+                for (uint32_t i = start; i != end; ++i)
+                    dst[i] += src[i];
+            },
+            bin_count, pairs * chunks);
+    }
+
+    // Free memory (happens asynchronously after the above stmts.)
+    jitc_free(priv);
+}
+
+void LLVMThreadState::histogram(VarType vt, uint32_t size,
+                                const uint32_t *values, const void *weights,
+                                uint32_t bin_count, void *out) {
+    if (unlikely(!weights && vt != VarType::UInt32))
+        jitc_raise("jit_histogram(): unweighted histograms must have type "
+                   "VarType::UInt32!");
+
+    if (bin_count == 0)
+        return;
+
+    if (size == 0) {
+        uint64_t zero = 0;
+        memset_async(out, bin_count, type_size[(int) vt], &zero);
+        return;
+    }
+
+    switch (vt) {
+        case VarType::UInt32:
+        case VarType::Int32:
+            llvm_histogram<uint32_t>(this, size, values, (const uint32_t *) weights,
+                                     bin_count, (uint32_t *) out);
+            break;
+        case VarType::UInt64:
+        case VarType::Int64:
+            llvm_histogram<uint64_t>(this, size, values, (const uint64_t *) weights,
+                                     bin_count, (uint64_t *) out);
+            break;
+        case VarType::Float32:
+            llvm_histogram<float>(this, size, values, (const float *) weights,
+                                  bin_count, (float *) out);
+            break;
+        case VarType::Float64:
+            llvm_histogram<double>(this, size, values, (const double *) weights,
+                                   bin_count, (double *) out);
+            break;
+        default:
+            jitc_raise("jit_histogram(): unsupported type \"%s\"!",
+                       type_name[(int) vt]);
+    }
+}
+
 void LLVMThreadState::memcpy(void *dst, const void *src, size_t size) {
     std::memcpy(dst, src, size);
 }
 
 void LLVMThreadState::memcpy_async(void *dst, const void *src, size_t size) {
     submit_cpu(
-        KernelType::Other,
+        this, KernelType::Other,
         [dst, src, size](uint32_t) {
             std::memcpy(dst, src, size);
         },
@@ -699,7 +1396,7 @@ void LLVMThreadState::aggregate(void *dst_, AggregationEntry *agg,
              (uintptr_t) agg, (uintptr_t) dst_, size, work_units);
 
     submit_cpu(
-        KernelType::Other,
+        this, KernelType::Other,
         [dst_, agg, size, work_unit_size](uint32_t index) {
             uint32_t start = index * work_unit_size,
                      end = std::min(start + work_unit_size, size);
@@ -725,17 +1422,17 @@ void LLVMThreadState::aggregate(void *dst_, AggregationEntry *agg,
         size, work_units);
 
     submit_cpu(
-        KernelType::Other, [agg](uint32_t) { free(agg); }, 1, 1);
+        this, KernelType::Other, [agg](uint32_t) { free(agg); }, 1, 1);
 }
 
 void LLVMThreadState::enqueue_host_func(void (*callback)(void *),
                                         void *payload) {
-    if (!jitc_task) {
+    if (!*task) {
         unlock_guard guard(state.lock);
         callback(payload);
     } else {
         submit_cpu(
-            KernelType::Other, [payload, callback](uint32_t) { callback(payload); }, 1, 1);
+            this, KernelType::Other, [payload, callback](uint32_t) { callback(payload); }, 1, 1);
     }
 }
 
@@ -828,7 +1525,7 @@ void LLVMThreadState::reduce_expanded(VarType vt, ReduceOp op, void *ptr,
     }
 
     submit_cpu(
-        KernelType::Reduce,
+        this, KernelType::Reduce,
         [ptr, block_size, exp, size, kernel](uint32_t index) {
             kernel(ptr, index * block_size,
                    std::min((index + 1) * block_size, size), exp, size);
@@ -1,12 +1,70 @@
 #include "internal.h"
 
+/**
+ * \brief Reference-counted array of kernel parameters
+ *
+ * Serves as the payload of kernel tasks, which receive it by reference
+ * instead of copying it. Instances are recycled through an arena once the
+ * last task using them has finished.
+ */
+struct alignas(8) LLVMParams {
+    /// Reference count (tasks may release it from worker threads)
+    std::atomic<uint32_t> refs;
+
+    /// Number of entries
+    uint32_t size;
+
+    /// Capacity is given by 2^bucket
+    uint32_t bucket;
+
+    /// The entries are stored right after this header
+    void **data() { return (void **) (this + 1); }
+};
+
 struct LLVMThreadState : ThreadState {
+    ~LLVMThreadState();
+
     Task *launch(Kernel kernel, KernelKey *key, XXH128_hash_t hash,
                  uint32_t size, std::vector<void *> *kernel_params,
                  const std::vector<uint32_t> *) override;
 
     void barrier() override;
 
+    /// Fuse the next launch with the following one (see \ref ThreadState::pipeline())
+    bool pipeline() override;
+
+    /// Submit a kernel task with the given payload (see \ref launch())
+    Task *submit(uint32_t blocks, LLVMParams *params, bool pipelined);
+
+    /// Payload of the most recent kernel launch (holds a reference)
+    LLVMParams *params_last = nullptr;
+
+    /// Kernels launched since the last barrier (see \ref barrier())
+    std::vector<Task *> scheduled_tasks;
+
+    /// Value of 'jitc_task' when the first of these kernels was launched
+    /// (holds a reference)
+    Task *scheduled_parent = nullptr;
+
+    /// Private task chain used instead of 'jitc_task' by high-priority
+    /// thread states (see \ref jitc_llvm_set_priority())
+    Task *task_private = nullptr;
+
+    /// Is the next launch followed by another stage of a pipelined launch?
+    bool pipeline_next = false;
+
+    /// Number of kernels collected for the current pipelined launch
+    uint32_t pipeline_stages = 0;
+
+    /// .. their number of work units
+    uint32_t pipeline_blocks = 0;
+
+    /// .. and the task payload that is being assembled
+    std::vector<void *> pipeline_payload;
+
+    /// Storage of the cancellation flag (see \ref jit_cancel())
+    std::atomic<bool> cancel_flag { false };
+
     /// Fill a device memory region with constants of a given type
     void memset_async(void *ptr, uint32_t size, uint32_t isize,
                       const void *src) override;
@@ -32,6 +90,16 @@ struct LLVMThreadState : ThreadState {
                     uint32_t bucket_count, uint32_t *perm,
                     uint32_t *offsets) override;
 
+    /// Stable sort of an array of keys and (optionally) of associated values
+    void sort(VarType vt, uint32_t size, const void *keys_in,
+              const uint32_t *values_in, void *keys_out,
+              uint32_t *values_out) override;
+
+    /// Accumulate (optionally weighted) entries of a 32-bit index array into bins
+    void histogram(VarType vt, uint32_t size, const uint32_t *values,
+                   const void *weights, uint32_t bin_count,
+                   void *out) override;
+
     /// Perform a synchronous copy operation
     void memcpy(void *dst, const void *src, size_t size) override;
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #if defined(__linux__) && !defined(DRJIT_USE_STD_MUTEX)
 #include <pthread.h>
 using Lock = pthread_spinlock_t;
@@ -33,22 +35,64 @@ inline void lock_acquire(Lock &lock) { lock.lock(); }
 inline void lock_release(Lock &lock) { lock.unlock(); }
 #endif
 
+/**
+ * \brief Lock that is skipped entirely in single-threaded mode
+ *
+ * When the application guarantees that Dr.Jit is only ever used from a single
+ * thread (see \ref jit_set_single_threaded()), acquiring and releasing the
+ * central locks is pure overhead. In this mode, acquisition of an
+ * 'ElidableLock' reduces to a well-predicted branch. Debug builds furthermore
+ * check that the calling thread is the one that enabled the mode.
+ */
+struct ElidableLock {
+    Lock lock;
+};
+
+/**
+ * Set when lock elision is active (see \ref ElidableLock). It is only modified
+ * while no other thread uses Dr.Jit, but other threads may still read it
+ * (e.g., to detect misuse). Relaxed loads compile to plain loads.
+ */
+extern std::atomic<bool> lock_elide;
+
+#if !defined(NDEBUG)
+/// Abort if an elided lock is accessed by a thread other than its owner
+extern void lock_elide_check();
+#endif
+
+inline void lock_init(ElidableLock &lock) { lock_init(lock.lock); }
+inline void lock_destroy(ElidableLock &lock) { lock_destroy(lock.lock); }
+
+inline void lock_acquire(ElidableLock &lock) {
+    if (!lock_elide.load(std::memory_order_relaxed))
+        lock_acquire(lock.lock);
+#if !defined(NDEBUG)
+    else
+        lock_elide_check();
+#endif
+}
+
+inline void lock_release(ElidableLock &lock) {
+    if (!lock_elide.load(std::memory_order_relaxed))
+        lock_release(lock.lock);
+}
+
 /// RAII helper for scoped lock acquisition
-class lock_guard {
+template <typename LockType> class lock_guard {
 public:
-    lock_guard(Lock &lock) : m_lock(lock) { lock_acquire(m_lock); }
+    lock_guard(LockType &lock) : m_lock(lock) { lock_acquire(m_lock); }
     ~lock_guard() { lock_release(m_lock); }
 
     lock_guard(const lock_guard &) = delete;
     lock_guard &operator=(const lock_guard &) = delete;
 private:
-    Lock &m_lock;
+    LockType &m_lock;
 };
 
 /// RAII helper for scoped lock release
-class unlock_guard {
+template <typename LockType> class unlock_guard {
 public:
-    unlock_guard(Lock &lock) : m_lock(lock) { lock_release(m_lock); }
+    unlock_guard(LockType &lock) : m_lock(lock) { lock_release(m_lock); }
     ~unlock_guard() {
         lock_acquire(m_lock);
         #if defined(DRJIT_SANITIZE_INTENSE)
@@ -58,5 +102,5 @@ public:
     unlock_guard(const unlock_guard &) = delete;
     unlock_guard &operator=(const unlock_guard &) = delete;
 private:
-    Lock &m_lock;
+    LockType &m_lock;
 };
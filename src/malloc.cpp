@@ -8,6 +8,7 @@
 */
 
 #include "internal.h"
+#include "llvm.h"
 #include "log.h"
 #include "util.h"
 #include "profile.h"
@@ -235,7 +236,29 @@ void jitc_free(void *ptr) {
     auto [size, type, device] = alloc_info_decode(info);
     state.alloc_usage[(int) type] -= size;
 
-    if (type != AllocType::HostPinned) {
+    if (type == AllocType::HostAsync && !jitc_llvm_high_chains.empty() &&
+        thread_state_llvm) {
+        /* Threads with different priorities process kernels in independent
+           task chains. Return the memory to the cache once the kernels of
+           the releasing thread's chain are done with it */
+        struct ReleaseRecord {
+            AllocInfo info;
+            void *ptr;
+        };
+        ReleaseRecord r { info, ptr };
+        ThreadState *ts = thread_state_llvm;
+
+        Task *new_task = task_submit_dep(
+            ts->pool, ts->task, 1, 1,
+            [](uint32_t, void *p) {
+                ReleaseRecord *r2 = (ReleaseRecord *) p;
+                lock_guard guard(state.alloc_free_lock);
+                state.alloc_free[r2->info].push_back(r2->ptr);
+            },
+            &r, sizeof(ReleaseRecord), nullptr, 1);
+        task_release(*ts->task);
+        *ts->task = new_task;
+    } else if (type != AllocType::HostPinned) {
         lock_guard guard(state.alloc_free_lock);
         state.alloc_free[info].push_back(ptr);
     } else {
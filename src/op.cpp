@@ -1377,6 +1377,12 @@ uint32_t jitc_var_rsqrt(uint32_t a0) {
 
 // --------------------------------------------------------------------------
 
+/// Accuracy tier of the LLVM backend's transcendental functions (1 = fast)
+static uint64_t jitc_var_math_tier(JitBackend backend) {
+    return backend == JitBackend::LLVM &&
+           (jit_flags() & (uint32_t) JitFlag::FastMath);
+}
+
 template <typename T, enable_if_t<drjit::detail::is_floating_point_v<T>> = 0>
 T eval_sin(T value) { return T(std::sin(value)); }
 
@@ -1384,7 +1390,7 @@ template <typename T, enable_if_t<!drjit::detail::is_floating_point_v<T>> = 0>
 T eval_sin(T) { jitc_fail("eval_sin(): unsupported operands!"); }
 
 uint32_t jitc_var_sin_intrinsic(uint32_t a0) {
-    auto [info, v0] = jitc_var_check<IsFloat | IsCUDA>("jit_var_sin", a0);
+    auto [info, v0] = jitc_var_check<IsFloat>("jit_var_sin_intrinsic", a0);
 
     uint32_t result = 0;
     if (info.simplify && info.literal)
@@ -1392,7 +1398,8 @@ uint32_t jitc_var_sin_intrinsic(uint32_t a0) {
 
     if (!result && info.size)
         result = jitc_var_new_node_1(info.backend, VarKind::Sin, info.type,
-                                     info.size, info.symbolic, a0, v0);
+                                     info.size, info.symbolic, a0, v0,
+                                     jitc_var_math_tier(info.backend));
 
     jitc_trace("jit_var_sin_intrinsic(r%u <- r%u)", result, a0);
     return result;
@@ -1407,7 +1414,7 @@ template <typename T, enable_if_t<!drjit::detail::is_floating_point_v<T>> = 0>
 T eval_cos(T) { jitc_fail("eval_cos(): unsupported operands!"); }
 
 uint32_t jitc_var_cos_intrinsic(uint32_t a0) {
-    auto [info, v0] = jitc_var_check<IsFloat | IsCUDA>("jit_var_cos_intrinsic", a0);
+    auto [info, v0] = jitc_var_check<IsFloat>("jit_var_cos_intrinsic", a0);
 
     uint32_t result = 0;
     if (info.simplify && info.literal)
@@ -1415,7 +1422,8 @@ uint32_t jitc_var_cos_intrinsic(uint32_t a0) {
 
     if (!result && info.size)
         result = jitc_var_new_node_1(info.backend, VarKind::Cos, info.type,
-                                     info.size, info.symbolic, a0, v0);
+                                     info.size, info.symbolic, a0, v0,
+                                     jitc_var_math_tier(info.backend));
 
     jitc_trace("jit_var_cos_intrinsic(r%u <- r%u)", result, a0);
     return result;
@@ -1430,7 +1438,7 @@ template <typename T, enable_if_t<!drjit::detail::is_floating_point_v<T>> = 0>
 T eval_exp2(T) { jitc_fail("eval_exp2(): unsupported operands!"); }
 
 uint32_t jitc_var_exp2_intrinsic(uint32_t a0) {
-    auto [info, v0] = jitc_var_check<IsFloat | IsCUDA>("jit_var_exp2_intrinsic", a0);
+    auto [info, v0] = jitc_var_check<IsFloat>("jit_var_exp2_intrinsic", a0);
 
     uint32_t result = 0;
     if (info.simplify && info.literal)
@@ -1438,7 +1446,8 @@ uint32_t jitc_var_exp2_intrinsic(uint32_t a0) {
 
     if (!result && info.size)
         result = jitc_var_new_node_1(info.backend, VarKind::Exp2, info.type,
-                                     info.size, info.symbolic, a0, v0);
+                                     info.size, info.symbolic, a0, v0,
+                                     jitc_var_math_tier(info.backend));
 
     jitc_trace("jit_var_exp2_intrinsic(r%u <- r%u)", result, a0);
     return result;
@@ -1453,7 +1462,7 @@ template <typename T, enable_if_t<!drjit::detail::is_floating_point_v<T>> = 0>
 T eval_log2(T) { jitc_fail("eval_log2(): unsupported operands!"); }
 
 uint32_t jitc_var_log2_intrinsic(uint32_t a0) {
-    auto [info, v0] = jitc_var_check<IsFloat | IsCUDA>("jit_var_log2_intrinsic", a0);
+    auto [info, v0] = jitc_var_check<IsFloat>("jit_var_log2_intrinsic", a0);
 
     uint32_t result = 0;
     if (info.simplify && info.literal)
@@ -1461,12 +1470,42 @@ uint32_t jitc_var_log2_intrinsic(uint32_t a0) {
 
     if (!result && info.size)
         result = jitc_var_new_node_1(info.backend, VarKind::Log2, info.type,
-                                     info.size, info.symbolic, a0, v0);
+                                     info.size, info.symbolic, a0, v0,
+                                     jitc_var_math_tier(info.backend));
 
     jitc_trace("jit_var_log2_intrinsic(r%u <- r%u)", result, a0);
     return result;
 }
 
+uint32_t jitc_var_philox(VarType vt, uint32_t counter, uint32_t stream,
+                         uint32_t seed) {
+    auto [info, v0, v1, v2] =
+        jitc_var_check("jit_var_philox", counter, stream, seed);
+
+    if (info.backend != JitBackend::LLVM)
+        jitc_raise("jit_var_philox(): this operation is currently only "
+                   "supported by the LLVM backend!");
+
+    if (info.type != VarType::UInt32)
+        jitc_raise("jit_var_philox(): the counter, stream, and seed must be "
+                   "unsigned 32-bit arrays!");
+
+    if (vt != VarType::UInt32 && vt != VarType::UInt64 &&
+        vt != VarType::Float32 && vt != VarType::Float64)
+        jitc_raise("jit_var_philox(): unsupported output type %s!",
+                   type_name[(int) vt]);
+
+    uint32_t result = 0;
+    if (info.size)
+        result = jitc_var_new_node_3(info.backend, VarKind::Philox, vt,
+                                     info.size, info.symbolic, counter, v0,
+                                     stream, v1, seed, v2);
+
+    jitc_trace("jit_var_philox(r%u <- r%u, r%u, r%u)", result, counter,
+               stream, seed);
+    return result;
+}
+
 // --------------------------------------------------------------------------
 
 uint32_t jitc_var_cast(uint32_t a0, VarType target_type, int reinterpret) {
@@ -1953,6 +1992,78 @@ void jitc_var_gather_packet(size_t n, uint32_t src_, uint32_t index, uint32_t ma
              (uint32_t) src, index, mask, (uint32_t) ptr_2);
 }
 
+uint32_t jitc_var_searchsorted(uint32_t src_, uint32_t value, int right) {
+    if (value == 0)
+        return 0;
+
+    Ref src = borrow(src_);
+
+    auto [src_info, src_v] =
+        jitc_var_check("jit_var_searchsorted", src_);
+    auto [var_info, value_v] =
+        jitc_var_check("jit_var_searchsorted", value);
+
+    unwrap(src, src_v);
+
+    VarType vt = (VarType) src_v->type;
+    if ((JitBackend) src_info.backend != JitBackend::LLVM)
+        jitc_raise("jit_var_searchsorted(): this operation is currently only "
+                   "supported by the LLVM backend!");
+
+    if ((VarType) value_v->type != vt)
+        jitc_raise("jit_var_searchsorted(): source and value have "
+                   "incompatible types (%s and %s)!",
+                   type_name[(int) vt], type_name[value_v->type]);
+
+    switch (vt) {
+        case VarType::Int32: case VarType::UInt32:
+        case VarType::Int64: case VarType::UInt64:
+        case VarType::Float32: case VarType::Float64:
+            break;
+
+        default:
+            jitc_raise("jit_var_searchsorted(): unsupported type %s!",
+                       type_name[(int) vt]);
+    }
+
+    if (src_v->symbolic)
+        jitc_raise("jit_var_searchsorted(): cannot search a symbolic "
+                   "variable (r%u, kind=%s)!",
+                   (uint32_t) src, var_kind_name[(int) src_v->kind]);
+
+    var_info.type = VarType::UInt32;
+
+    uint32_t n = src_info.size;
+    if (n == 0)
+        return jitc_make_zero(var_info);
+
+    if (unlikely(value_v->is_dirty())) {
+        jitc_eval(thread_state(src_info.backend));
+        if (jitc_var(value)->is_dirty())
+            jitc_raise_dirty_error(value);
+    }
+
+    jitc_var_eval(src);
+
+    /* The array size is passed as an opaque scalar so that the generated
+       kernel does not depend on it. The search loop nevertheless runs for
+       a fixed number of iterations that is uniform across lanes. */
+    Ref ptr = steal(jitc_var_pointer(src_info.backend, jitc_var(src)->data, src, 0)),
+        size = steal(jitc_var_literal(src_info.backend, VarType::UInt32, &n, 1, 1));
+
+    uint32_t result = jitc_var_new_node_3(
+        src_info.backend, VarKind::SearchSorted, VarType::UInt32,
+        var_info.size, var_info.symbolic, ptr, jitc_var(ptr), value,
+        jitc_var(value), size, jitc_var(size), (uint64_t) (right != 0));
+
+    jitc_log(Debug,
+             "jit_var_searchsorted(): r%u[%u] = searchsorted_%s(r%u, r%u) (ptr=r%u)",
+             result, var_info.size, right ? "right" : "left", (uint32_t) src,
+             value, (uint32_t) ptr);
+
+    return result;
+}
+
 static const char *reduce_op_symbol[(int) ReduceOp::Count] = {
     "=", "+=", "*=", "= min", "= max", "&=", "|="
 };
@@ -2228,7 +2339,8 @@ bool jitc_can_scatter_reduce(JitBackend backend, VarType vt, ReduceOp op) {
 }
 
 static const char *mode_name[] = { "auto",        "direct", "local",
-                                   "no_conflict", "expand", "permute" };
+                                   "no_conflict", "expand", "permute",
+                                   "conflict" };
 
 /// Logic related to choosing the 'ReduceMode' of a scatter(-reduction)
 static std::pair<ReduceMode, bool>
@@ -2258,6 +2370,10 @@ jitc_var_infer_reduce_mode(const char *name, JitBackend backend, Ref &target,
             // ReduceMode::Expand is only supported on the LLVM backend
             if (mode == ReduceMode::Expand)
                 mode = ReduceMode::Auto;
+
+            // .. as is ReduceMode::Conflict
+            if (mode == ReduceMode::Conflict)
+                mode = ReduceMode::Local;
         }
 
         if (mode == ReduceMode::Auto)
@@ -2755,3 +2871,71 @@ uint32_t jitc_var_op(JitOp op, const uint32_t *dep) {
         default: jitc_raise("jit_var_new_op(): unsupported operation!");
     }
 }
+
+/// Number of operands consumed by a given operation
+static uint32_t jitc_op_arity(JitOp op) {
+    switch (op) {
+        case JitOp::Neg:  case JitOp::Not:   case JitOp::Sqrt:  case JitOp::Abs:
+        case JitOp::Ceil: case JitOp::Floor: case JitOp::Round: case JitOp::Trunc:
+        case JitOp::Popc: case JitOp::Clz:   case JitOp::Ctz:   case JitOp::Brev:
+        case JitOp::Rcp:  case JitOp::Rsqrt: case JitOp::Sin:   case JitOp::Cos:
+        case JitOp::Exp2: case JitOp::Log2:
+            return 1;
+
+        case JitOp::Fma: case JitOp::Select:
+            return 3;
+
+        case JitOp::Count:
+            return 0;
+
+        default:
+            return 2;
+    }
+}
+
+/// Slot table of jitc_var_op_batch(), reused across calls (protected by 'state.lock')
+static std::vector<uint32_t> op_batch_slots;
+
+uint32_t jitc_var_op_batch(JitBackend backend, const uint32_t *in,
+                           uint32_t n_in, const JitBatchOp *ops,
+                           uint32_t n_ops) {
+    if (unlikely(n_ops == 0))
+        jitc_raise("jit_var_op_batch(): the operation list is empty!");
+
+    std::vector<uint32_t> &slots = op_batch_slots;
+    slots.clear();
+    slots.insert(slots.end(), in, in + n_in);
+
+    try {
+        for (uint32_t i = 0; i < n_ops; ++i) {
+            const JitBatchOp &o = ops[i];
+            uint32_t arity = jitc_op_arity(o.op),
+                     dep[3] = { 0, 0, 0 }, result;
+
+            for (uint32_t j = 0; j < arity; ++j) {
+                uint32_t slot = o.arg[j];
+                if (unlikely(slot >= n_in + i))
+                    jitc_raise("jit_var_op_batch(): operation %u references "
+                               "slot %u, which is not yet defined!", i, slot);
+                dep[j] = slots[slot];
+            }
+
+            if (o.op == JitOp::Count)
+                result = jitc_var_literal(backend, o.type, &o.literal, 1, 0);
+            else
+                result = jitc_var_op(o.op, dep);
+
+            slots.push_back(result);
+        }
+    } catch (...) {
+        for (size_t i = n_in; i < slots.size(); ++i)
+            jitc_var_dec_ref(slots[i]);
+        throw;
+    }
+
+    // Release intermediate results, only keep the final one
+    for (uint32_t i = n_in; i + 1 < n_in + n_ops; ++i)
+        jitc_var_dec_ref(slots[i]);
+
+    return slots.back();
+}
@@ -14,6 +14,11 @@
 /// Create a variable representing the result of a standard operation
 extern uint32_t jitc_var_op(JitOp ot, const uint32_t *dep);
 
+/// Materialize a sequence of standard operations (see \ref jit_var_op_batch())
+extern uint32_t jitc_var_op_batch(JitBackend backend, const uint32_t *in,
+                                  uint32_t n_in, const JitBatchOp *ops,
+                                  uint32_t n_ops);
+
 /// Create a variable that reads from another variable
 extern uint32_t jitc_var_gather(uint32_t source, uint32_t index,
                                 uint32_t mask);
@@ -22,6 +27,10 @@ extern uint32_t jitc_var_gather(uint32_t source, uint32_t index,
 extern void jitc_var_gather_packet(size_t n, uint32_t source, uint32_t index,
                               uint32_t mask, uint32_t *out);
 
+/// Locate insertion points of 'value' within the sorted array 'source'
+extern uint32_t jitc_var_searchsorted(uint32_t source, uint32_t value,
+                                      int right);
+
 /// Schedule a scatter opartion that writes to an array
 extern uint32_t jitc_var_scatter(uint32_t target, uint32_t value,
                                  uint32_t index, uint32_t mask,
@@ -113,6 +122,10 @@ extern uint32_t jitc_var_cos_intrinsic(uint32_t a0);
 extern uint32_t jitc_var_exp2_intrinsic(uint32_t a0);
 extern uint32_t jitc_var_log2_intrinsic(uint32_t a0);
 
+/// Counter-based random number generator
+extern uint32_t jitc_var_philox(VarType vt, uint32_t counter, uint32_t stream,
+                                uint32_t seed);
+
 /// Extra data describing a packet scatter operatoin
 struct PacketScatterData {
     ReduceOp op     = ReduceOp::Identity;
@@ -139,8 +139,8 @@
 const char *op_type_name[(int) OpType::Count]{
     "Barrier",        "KernelLaunch",      "MemsetAsync", "Expand",
     "ReduceExpanded", "Compress",          "MemcpyAsync", "Mkperm",
-    "BlockReduce",    "BlockPrefixReduce", "ReduceDot",   "Aggregate",
-    "Free",
+    "Sort",           "Histogram",         "BlockReduce",
+    "BlockPrefixReduce", "ReduceDot",      "Aggregate",   "Free",
 };
 
 static bool dry_run = false;
@@ -277,6 +277,8 @@ static ProfilerRegion pr_expand("Expand");
 static ProfilerRegion pr_compress("Compress");
 static ProfilerRegion pr_memcpy_async("MemcpyAsync");
 static ProfilerRegion pr_mkperm("Mkperm");
+static ProfilerRegion pr_sort("Sort");
+static ProfilerRegion pr_histogram("Histogram");
 static ProfilerRegion pr_block_reduce("BlockReduce");
 static ProfilerRegion pr_block_prefix_reduce("BlockPrefixReduce");
 static ProfilerRegion pr_reduce_dot("ReduceDot");
@@ -357,6 +359,14 @@ int Recording::replay(const uint32_t *replay_inputs, uint32_t *replay_outputs) {
                 if (!replay_mkperm(op))
                     return false;
                 break;
+            case OpType::Sort:
+                if (!replay_sort(op))
+                    return false;
+                break;
+            case OpType::Histogram:
+                if (!replay_histogram(op))
+                    return false;
+                break;
             case OpType::BlockReduce:
                 if (!replay_block_reduce(op))
                     return false;
@@ -1399,6 +1409,181 @@ int Recording::replay_mkperm(Operation &op) {
     return true;
 }
 
+/// Stable sort of an array of keys and (optionally) of associated values
+void RecordThreadState::sort(VarType vt, uint32_t size, const void *keys_in,
+                             const uint32_t *values_in, void *keys_out,
+                             uint32_t *values_out) {
+    if (!paused()) {
+        try {
+            record_sort(vt, size, keys_in, values_in, keys_out, values_out);
+        } catch (...) {
+            record_exception();
+        }
+    }
+    pause_scope pause(this);
+    return m_internal->sort(vt, size, keys_in, values_in, keys_out,
+                            values_out);
+}
+
+void RecordThreadState::record_sort(VarType vt, uint32_t size,
+                                    const void *keys_in,
+                                    const uint32_t *values_in, void *keys_out,
+                                    uint32_t *values_out) {
+    jitc_log(LogLevel::Debug,
+             "record(): sort(vt=%s, size=%u, keys_in=%p, values_in=%p, "
+             "keys_out=%p, values_out=%p)",
+             type_name[(uint32_t) vt], size, keys_in, values_in, keys_out,
+             values_out);
+
+    uint32_t start = (uint32_t) m_recording.dependencies.size();
+    add_in_param(keys_in, vt);
+    add_out_param(keys_out, vt);
+    if (values_in) {
+        add_in_param(values_in, VarType::UInt32);
+        add_out_param(values_out, VarType::UInt32);
+    }
+    uint32_t end = (uint32_t) m_recording.dependencies.size();
+
+    Operation op;
+    op.type             = OpType::Sort;
+    op.dependency_range = std::pair(start, end);
+    op.size             = size;
+    m_recording.operations.push_back(op);
+}
+
+int Recording::replay_sort(Operation &op) {
+    ProfilerPhase profiler(pr_sort);
+
+    uint32_t dependency_index = op.dependency_range.first;
+    bool has_values = op.dependency_range.second - dependency_index == 4;
+
+    AccessInfo keys_in_info  = dependencies[dependency_index];
+    AccessInfo keys_out_info = dependencies[dependency_index + 1];
+
+    ReplayVariable &keys_in_var  = replay_variables[keys_in_info.slot];
+    ReplayVariable &keys_out_var = replay_variables[keys_out_info.slot];
+
+    uint32_t size = keys_in_var.size(keys_in_info.vtype);
+    keys_out_var.alloc(backend, size, keys_out_info.vtype);
+
+    void *values_in = nullptr, *values_out = nullptr;
+    if (has_values) {
+        AccessInfo values_in_info  = dependencies[dependency_index + 2];
+        AccessInfo values_out_info = dependencies[dependency_index + 3];
+
+        ReplayVariable &values_in_var  = replay_variables[values_in_info.slot];
+        ReplayVariable &values_out_var = replay_variables[values_out_info.slot];
+
+        if (values_in_var.size(values_in_info.vtype) != size) {
+            if (dry_run)
+                return false;
+            jitc_fail("replay(): the keys and values of a sort operation "
+                      "have incompatible sizes!");
+        }
+
+        values_out_var.alloc(backend, size, values_out_info.vtype);
+        values_in = values_in_var.data;
+        values_out = values_out_var.data;
+    }
+
+    jitc_log(LogLevel::Debug,
+             "replay(): sort(vt=%s, size=%u, keys_in=%p, values_in=%p, "
+             "keys_out=%p, values_out=%p)",
+             type_name[(uint32_t) keys_in_info.vtype], size, keys_in_var.data,
+             values_in, keys_out_var.data, values_out);
+
+    if (!dry_run)
+        ts->sort(keys_in_info.vtype, size, keys_in_var.data,
+                 (const uint32_t *) values_in, keys_out_var.data,
+                 (uint32_t *) values_out);
+
+    return true;
+}
+
+/// Accumulate (optionally weighted) entries of a 32-bit index array into bins
+void RecordThreadState::histogram(VarType vt, uint32_t size,
+                                  const uint32_t *values, const void *weights,
+                                  uint32_t bin_count, void *out) {
+    if (!paused()) {
+        try {
+            record_histogram(vt, size, values, weights, bin_count, out);
+        } catch (...) {
+            record_exception();
+        }
+    }
+    pause_scope pause(this);
+    return m_internal->histogram(vt, size, values, weights, bin_count, out);
+}
+
+void RecordThreadState::record_histogram(VarType vt, uint32_t size,
+                                         const uint32_t *values,
+                                         const void *weights,
+                                         uint32_t bin_count, void *out) {
+    jitc_log(LogLevel::Debug,
+             "record(): histogram(vt=%s, size=%u, values=%p, weights=%p, "
+             "bin_count=%u, out=%p)",
+             type_name[(uint32_t) vt], size, values, weights, bin_count, out);
+
+    uint32_t start = (uint32_t) m_recording.dependencies.size();
+    add_in_param(values);
+    add_out_param(out, vt);
+    if (weights)
+        add_in_param(weights, vt);
+    uint32_t end = (uint32_t) m_recording.dependencies.size();
+
+    Operation op;
+    op.type             = OpType::Histogram;
+    op.dependency_range = std::pair(start, end);
+    op.size             = size;
+    op.bucket_count     = bin_count;
+    m_recording.operations.push_back(op);
+}
+
+int Recording::replay_histogram(Operation &op) {
+    ProfilerPhase profiler(pr_histogram);
+
+    uint32_t dependency_index = op.dependency_range.first;
+    bool has_weights = op.dependency_range.second - dependency_index == 3;
+
+    AccessInfo values_info = dependencies[dependency_index];
+    AccessInfo out_info    = dependencies[dependency_index + 1];
+
+    ReplayVariable &values_var = replay_variables[values_info.slot];
+    ReplayVariable &out_var    = replay_variables[out_info.slot];
+
+    uint32_t size      = values_var.size(values_info.vtype),
+             bin_count = op.bucket_count;
+
+    out_var.alloc(backend, bin_count, out_info.vtype);
+
+    void *weights = nullptr;
+    if (has_weights) {
+        AccessInfo weights_info = dependencies[dependency_index + 2];
+        ReplayVariable &weights_var = replay_variables[weights_info.slot];
+
+        if (weights_var.size(weights_info.vtype) != size) {
+            if (dry_run)
+                return false;
+            jitc_fail("replay(): the values and weights of a histogram "
+                      "operation have incompatible sizes!");
+        }
+
+        weights = weights_var.data;
+    }
+
+    jitc_log(LogLevel::Debug,
+             "replay(): histogram(vt=%s, size=%u, values=%p, weights=%p, "
+             "bin_count=%u, out=%p)",
+             type_name[(uint32_t) out_info.vtype], size, values_var.data,
+             weights, bin_count, out_var.data);
+
+    if (!dry_run)
+        ts->histogram(out_info.vtype, size, (const uint32_t *) values_var.data,
+                      weights, bin_count, out_var.data);
+
+    return true;
+}
+
 /// Sum over elements within blocks
 void RecordThreadState::block_reduce(VarType vt, ReduceOp op, uint32_t size,
                                      uint32_t block_size, const void *in,
@@ -34,6 +34,8 @@ enum class OpType {
     Compress,
     MemcpyAsync,
     Mkperm,
+    Sort,
+    Histogram,
     BlockReduce,
     BlockPrefixReduce,
     ReduceDot,
@@ -75,9 +77,9 @@ struct Operation {
             bool reverse;
         } prefix_reduce;
 
-        /// Bucket count for the mkperm operation. The function has to be
-        /// re-recorded when the bucket count changes. Therefore this should not
-        /// depend on the width of any variable.
+        /// Bucket count for the mkperm and histogram operations. The function
+        /// has to be re-recorded when the bucket count changes. Therefore this
+        /// should not depend on the width of any variable.
         uint32_t bucket_count;
 
         /// Additional data such as the source of memset
@@ -288,6 +290,10 @@ struct Recording {
 
     int replay_mkperm(Operation &op);
 
+    int replay_sort(Operation &op);
+
+    int replay_histogram(Operation &op);
+
     int replay_block_reduce(Operation &op);
 
     int replay_block_prefix_reduce(Operation &op);
@@ -352,6 +358,11 @@ public:
         this->call_self_value = internal->call_self_value;
         this->call_self_index = internal->call_self_index;
 
+        this->priority  = internal->priority;
+        this->pool      = internal->pool;
+        this->task      = internal->task;
+        this->cancelled = internal->cancelled;
+
 #if defined(DRJIT_ENABLE_OPTIX)
         this->optix_pipeline = internal->optix_pipeline;
         this->optix_sbt      = internal->optix_sbt;
@@ -383,6 +394,16 @@ public:
                     uint32_t bucket_count, uint32_t *perm,
                     uint32_t *offsets) override;
 
+    /// Stable sort of an array of keys and (optionally) of associated values
+    void sort(VarType vt, uint32_t size, const void *keys_in,
+              const uint32_t *values_in, void *keys_out,
+              uint32_t *values_out) override;
+
+    /// Accumulate (optionally weighted) entries of a 32-bit index array into bins
+    void histogram(VarType vt, uint32_t size, const uint32_t *values,
+                   const void *weights, uint32_t bin_count,
+                   void *out) override;
+
     /// Perform a synchronous copy operation
     void memcpy(void *dst, const void *src, size_t size) override;
 
@@ -520,6 +541,11 @@ public:
     void record_mkperm(const uint32_t *values, uint32_t size,
                        uint32_t bucket_count, uint32_t *perm,
                        uint32_t *offsets);
+    void record_sort(VarType vt, uint32_t size, const void *keys_in,
+                     const uint32_t *values_in, void *keys_out,
+                     uint32_t *values_out);
+    void record_histogram(VarType vt, uint32_t size, const uint32_t *values,
+                          const void *weights, uint32_t bin_count, void *out);
     void record_block_reduce(VarType vt, ReduceOp op, uint32_t size,
                              uint32_t block_size, const void *in, void *out);
     void record_block_prefix_reduce(VarType vt, ReduceOp op, uint32_t size,
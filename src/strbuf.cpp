@@ -4,8 +4,10 @@
 #include "eval.h"
 #include <cstdarg>
 
-/// Global string buffer used to generate PTX/LLVM IR
-StringBuffer buffer { 1024 };
+/// String buffer used to generate PTX/LLVM IR. It is thread-local, since
+/// other threads may trace while an LLVM kernel compiles from its contents
+/// without holding the central lock (see jitc_run()).
+thread_local StringBuffer buffer { 1024 };
 
 static const char num[] = "0123456789abcdef";
 
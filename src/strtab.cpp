@@ -0,0 +1,115 @@
+/*
+    src/strtab.cpp -- Reference-counted table of interned strings
+
+    Variables created while a prefix is active (jit_prefix_push()) or in debug
+    mode carry a descriptive label. Previously, each of them owned a separate
+    heap-allocated copy, which meant that traces with millions of labeled
+    variables performed millions of malloc()/free() calls to store the same
+    few strings. Labels and prefixes are now interned in the table below:
+    identical strings are stored once, and attaching an existing string to
+    a variable only increases its reference count.
+
+    Copyright (c) 2024 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#include "strtab.h"
+#include "internal.h"
+#include "hash.h"
+#include "log.h"
+#include <vector>
+
+/// Header preceding the characters of every interned string
+struct StrEntry {
+    uint32_t ref_count;
+    uint32_t length;
+    char str[1];
+};
+
+struct StrKey {
+    const char *str;
+    size_t length;
+    size_t hash;
+
+    StrKey(const char *str, size_t length)
+        : str(str), length(length), hash(::hash(str, length)) { }
+
+    bool operator==(const StrKey &k) const {
+        return length == k.length && memcmp(str, k.str, length) == 0;
+    }
+};
+
+struct StrKeyHasher {
+    size_t operator()(const StrKey &k) const { return k.hash; }
+};
+
+/// Maps string contents to entries (the key references the entry's storage)
+static tsl::robin_map<StrKey, StrEntry *, StrKeyHasher> str_table;
+
+/// Scratch space for jitc_str_intern_concat()
+static std::vector<char> str_scratch;
+
+static StrEntry *str_entry(const char *s) {
+    return (StrEntry *) (s - offsetof(StrEntry, str));
+}
+
+const char *jitc_str_intern(const char *s, size_t len) {
+    StrKey key(s, len);
+    auto it = str_table.find(key);
+    if (it != str_table.end()) {
+        it.value()->ref_count++;
+        return it.value()->str;
+    }
+
+    StrEntry *e = (StrEntry *) malloc_check(offsetof(StrEntry, str) + len + 1);
+    e->ref_count = 1;
+    e->length = (uint32_t) len;
+    memcpy(e->str, s, len);
+    e->str[len] = '\0';
+
+    key.str = e->str;
+    str_table.emplace(key, e);
+    return e->str;
+}
+
+const char *jitc_str_intern_concat(const char *s1, size_t len1,
+                                   const char *s2, size_t len2) {
+    str_scratch.resize(len1 + len2);
+    if (len1)
+        memcpy(str_scratch.data(), s1, len1);
+    if (len2)
+        memcpy(str_scratch.data() + len1, s2, len2);
+    return jitc_str_intern(str_scratch.data(), len1 + len2);
+}
+
+const char *jitc_str_inc_ref(const char *s) {
+    if (s)
+        str_entry(s)->ref_count++;
+    return s;
+}
+
+void jitc_str_dec_ref(const char *s) {
+    if (!s)
+        return;
+
+    StrEntry *e = str_entry(s);
+    if (--e->ref_count == 0) {
+        str_table.erase(StrKey(e->str, e->length));
+        free(e);
+    }
+}
+
+size_t jitc_str_len(const char *s) {
+    return str_entry(s)->length;
+}
+
+void jitc_str_shutdown() {
+    /* Leaked variables are reported by jit_shutdown(), their labels
+       are simply released here */
+    for (auto &kv : str_table)
+        free(kv.second);
+    str_table.clear();
+    str_scratch = std::vector<char>();
+}
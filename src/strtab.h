@@ -0,0 +1,38 @@
+/*
+    src/strtab.h -- Reference-counted table of interned strings
+
+    Copyright (c) 2024 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * \brief Intern the string <tt>s[0..len)</tt> and return a handle
+ *
+ * The handle is an ordinary zero-terminated string that remains valid until
+ * its reference count drops to zero. Interning the same contents again
+ * returns the same handle with an increased reference count. The caller must
+ * hold \c state.lock.
+ */
+extern const char *jitc_str_intern(const char *s, size_t len);
+
+/// Intern the concatenation of two strings (see \ref jitc_str_intern())
+extern const char *jitc_str_intern_concat(const char *s1, size_t len1,
+                                          const char *s2, size_t len2);
+
+/// Increase the reference count of an interned string (may be \c nullptr)
+extern const char *jitc_str_inc_ref(const char *s);
+
+/// Decrease the reference count of an interned string (may be \c nullptr)
+extern void jitc_str_dec_ref(const char *s);
+
+/// Return the length of an interned string
+extern size_t jitc_str_len(const char *s);
+
+/// Release all remaining interned strings
+extern void jitc_str_shutdown();
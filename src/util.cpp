@@ -35,6 +35,7 @@ void jitc_memcpy(JitBackend backend, void *dst, const void *src, size_t size) {
 
     // Temporarily release the lock while copying
     jitc_sync_thread(ts);
+    jitc_check_cancelled();
     ts->memcpy(dst, src, size);
 }
 
@@ -132,6 +133,8 @@ bool jitc_all(JitBackend backend, uint8_t *values, uint32_t size) {
 
     jitc_all_async_4(backend, values, size, tmp);
     jitc_sync_thread();
+    if (backend == JitBackend::LLVM)
+        jitc_check_cancelled();
 
     bool result = (tmp[0] & tmp[1] & tmp[2] & tmp[3]) != 0;
 
@@ -151,6 +154,8 @@ bool jitc_any(JitBackend backend, uint8_t *values, uint32_t size) {
 
     jitc_any_async_4(backend, values, size, tmp);
     jitc_sync_thread();
+    if (backend == JitBackend::LLVM)
+        jitc_check_cancelled();
 
     bool result = (tmp[0] | tmp[1] | tmp[2] | tmp[3]) != 0;
 
@@ -175,6 +180,27 @@ uint32_t jitc_mkperm(JitBackend backend, const uint32_t *ptr, uint32_t size,
     return thread_state(backend)->mkperm(ptr, size, bucket_count, perm, offsets);
 }
 
+static ProfilerRegion profiler_region_sort("jit_sort");
+
+/// Stable sort of an array of keys and (optionally) of associated values
+void jitc_sort(JitBackend backend, VarType vt, uint32_t size,
+               const void *keys_in, const uint32_t *values_in,
+               void *keys_out, uint32_t *values_out) {
+    ProfilerPhase profiler(profiler_region_sort);
+    thread_state(backend)->sort(vt, size, keys_in, values_in, keys_out,
+                                values_out);
+}
+
+static ProfilerRegion profiler_region_histogram("jit_histogram");
+
+/// Accumulate (optionally weighted) entries of a 32-bit index array into bins
+void jitc_histogram(JitBackend backend, VarType vt, uint32_t size,
+                    const uint32_t *values, const void *weights,
+                    uint32_t bin_count, void *out) {
+    ProfilerPhase profiler(profiler_region_histogram);
+    thread_state(backend)->histogram(vt, size, values, weights, bin_count, out);
+}
+
 /// Asynchronously update a single element in memory
 void jitc_poke(JitBackend backend, void *dst, const void *src, uint32_t size) {
     thread_state(backend)->poke(dst, src, size);
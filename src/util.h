@@ -61,6 +61,16 @@ extern uint32_t jitc_mkperm(JitBackend backend, const uint32_t *values, uint32_t
                             uint32_t bucket_count, uint32_t *perm,
                             uint32_t *offsets);
 
+/// Stable sort of an array of keys and (optionally) of associated values
+extern void jitc_sort(JitBackend backend, VarType vt, uint32_t size,
+                      const void *keys_in, const uint32_t *values_in,
+                      void *keys_out, uint32_t *values_out);
+
+/// Accumulate (optionally weighted) entries of a 32-bit index array into bins
+extern void jitc_histogram(JitBackend backend, VarType vt, uint32_t size,
+                           const uint32_t *values, const void *weights,
+                           uint32_t bin_count, void *out);
+
 /// Perform a synchronous copy operation
 extern void jitc_memcpy(JitBackend backend, void *dst, const void *src, size_t size);
 
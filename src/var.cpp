@@ -15,6 +15,7 @@
 #include "util.h"
 #include "op.h"
 #include "registry.h"
+#include "strtab.h"
 #include "llvm.h"
 
 /// Descriptive names for the various variable types
@@ -194,9 +195,15 @@ const char *var_kind_name[(int) VarKind::Count] {
     // Scatter multiple contiguous values at once
     "packet_scatter",
 
+    // Binary search within a sorted array
+    "searchsorted",
+
     // Counter node to determine the current lane ID
     "counter",
 
+    // Counter-based random number generator (Philox2x32-10)
+    "philox",
+
     // Default mask used to ignore out-of-range SIMD lanes (LLVM)
     "default_mask",
 
@@ -300,7 +307,7 @@ JIT_NOINLINE void jitc_var_free(uint32_t index, Variable *v) noexcept {
         if (unlikely(v->extra)) {
             uint32_t index2 = v->extra;
             VariableExtra &extra = state_.extra[index2];
-            char *label = extra.label;
+            const char *label = extra.label;
 
             /* Notify callback that the variable was freed.
                Do this first, before freeing any dependencies */
@@ -313,7 +320,7 @@ JIT_NOINLINE void jitc_var_free(uint32_t index, Variable *v) noexcept {
                 }
             }
 
-            free(label);
+            jitc_str_dec_ref(label);
             state_.unused_extra.push(index2);
         }
 
@@ -550,24 +557,17 @@ void jitc_var_set_label(uint32_t index, const char *label) {
     Variable *v = jitc_var(index);
     ThreadState *ts = thread_state(v->backend);
     VariableExtra *e = jitc_var_extra(v);
-    free(e->label);
+    const char *prev = e->label;
 
-    if (!ts->prefix) {
-        if (!label) {
-            e->label = nullptr;
-        } else {
-            e->label = (char *) malloc_check(len + 1);
-            memcpy(e->label, label, len + 1);
-        }
-    } else {
-        size_t prefix_len = strlen(ts->prefix);
-        char *combined = (char *) malloc_check(prefix_len + len + 1);
-        memcpy(combined, ts->prefix, prefix_len);
-        if (len)
-            memcpy(combined + prefix_len, label, len);
-        combined[prefix_len + len] = '\0';
-        e->label = combined;
-    }
+    if (!ts->prefix)
+        e->label = label ? jitc_str_intern(label, len) : nullptr;
+    else if (!len)
+        e->label = jitc_str_inc_ref(ts->prefix);
+    else
+        e->label = jitc_str_intern_concat(ts->prefix, jitc_str_len(ts->prefix),
+                                          label, len);
+
+    jitc_str_dec_ref(prev);
 
     jitc_log(Debug, "jit_var_set_label(): r%u.label = \"%s\"", index,
              label ? label : "(null)");
@@ -660,21 +660,14 @@ uint32_t jitc_var_new(Variable &v, bool disable_lvn) {
              has_loc = (flags & (uint32_t) JitFlag::Debug) && (source_location_buf[0] != '\0');
 
         if (unlikely(has_prefix || has_loc)) {
-            size_t size_prefix = has_prefix ? strlen(ts->prefix) : 0,
-                   size_loc    = has_loc ? strlen(source_location_buf) : 0;
-            char *s = (char *) malloc_check(size_prefix + size_loc + 1), *p = s;
-            if (has_prefix) {
-                memcpy(p, ts->prefix, size_prefix);
-                p += size_prefix;
-            }
-
-            if (size_loc) {
-                memcpy(p, source_location_buf, size_loc);
-                p += size_loc;
-            }
-
-            *p++ = '\0';
-            jitc_var_extra(vo)->label = s;
+            const char *label;
+            if (!has_loc)
+                label = jitc_str_inc_ref(ts->prefix);
+            else
+                label = jitc_str_intern_concat(
+                    ts->prefix, has_prefix ? jitc_str_len(ts->prefix) : 0,
+                    source_location_buf, strlen(source_location_buf));
+            jitc_var_extra(vo)->label = label;
         }
 
         st.variable_counter++;
@@ -1285,6 +1278,11 @@ static void jitc_raise_consumed_error(const char *func, uint32_t index) {
                func, index, var_kind_name[jitc_var(index)->kind]);
 }
 
+static void jitc_raise_released_error(const char *func, uint32_t index) {
+    jitc_raise("%s(r%u): the variable was computed by a cancelled kernel and "
+               "has been released (see jit_cancel())!", func, index);
+}
+
 /// Force-evaluate a variable of type 'literal' or 'undefined'
 uint32_t jitc_var_eval_force(uint32_t index, Variable &v_, void **ptr_out) {
     Variable v = v_;
@@ -1322,6 +1320,8 @@ uint32_t jitc_var_data(uint32_t index, bool eval_dirty, void **ptr_out) {
     if (v->is_literal() || v->is_undefined()) {
         return jitc_var_eval_force(index, *v, ptr_out);
     } else if (v->is_evaluated()) {
+        if (unlikely(!v->data))
+            jitc_raise_released_error("jit_var_data", index);
         if (v->is_dirty() && eval_dirty) {
             jitc_eval(thread_state(v->backend));
             v = jitc_var(index);
@@ -1353,7 +1353,7 @@ VarState jitc_var_state(uint32_t index) {
     else if (v->is_dirty())
         return VarState::Dirty;
     else if (v->is_evaluated())
-        return VarState::Evaluated;
+        return v->data ? VarState::Evaluated : VarState::Invalid;
     else if (v->is_literal())
         return VarState::Literal;
     else if (v->is_undefined())
@@ -1363,7 +1363,7 @@ VarState jitc_var_state(uint32_t index) {
 }
 
 /// Schedule a variable \c index for future evaluation via \ref jit_eval()
-int jitc_var_schedule(uint32_t index) {
+int jitc_var_schedule(uint32_t index, bool deferrable) {
     if (index == 0)
         return 0;
 
@@ -1375,11 +1375,15 @@ int jitc_var_schedule(uint32_t index) {
         jitc_raise_consumed_error("jit_var_schedule", index);
 
     if (v->is_node()) {
-        thread_state(v->backend)->scheduled.emplace_back(index, v->counter);
+        ThreadState *ts = thread_state(v->backend);
+        (deferrable ? ts->scheduled_deferrable : ts->scheduled)
+            .emplace_back(index, v->counter);
         jitc_log(Debug, "jit_var_schedule(r%u)", index);
         return 1;
     } else if (v->is_dirty()) {
         return 1;
+    } else if (unlikely(v->is_evaluated() && !v->data)) {
+        jitc_raise_released_error("jit_var_schedule", index);
     }
 
     return 0;
@@ -2050,7 +2054,15 @@ uint32_t jitc_var_compress(uint32_t index) {
             backend == JitBackend::CUDA ? AllocType::Device : AllocType::HostAsync,
             size_in * sizeof(uint32_t));
 
-        uint32_t size_out = jitc_compress(backend, ptr, size_in, indices_out);
+        uint32_t size_out;
+        try {
+            size_out = jitc_compress(backend, ptr, size_in, indices_out);
+        } catch (...) {
+            // The computation may have been cancelled (see jit_cancel())
+            jitc_free(indices_out);
+            throw;
+        }
+
         if (size_out > 0) {
             return jitc_var_mem_map(backend, VarType::UInt32, indices_out, size_out, 1);
         } else {
@@ -2060,6 +2072,104 @@ uint32_t jitc_var_compress(uint32_t index) {
     }
 }
 
+void jitc_var_sort(uint32_t keys, uint32_t values, uint32_t *keys_out,
+                   uint32_t *values_out) {
+    if (!keys) {
+        *keys_out = 0;
+        if (values_out)
+            *values_out = 0;
+        return;
+    }
+
+    const Variable *k = jitc_var(keys);
+    JitBackend backend = (JitBackend) k->backend;
+    VarType vt = (VarType) k->type;
+    uint32_t size = k->size;
+
+    if (values) {
+        const Variable *v = jitc_var(values);
+        if (unlikely((VarType) v->type != VarType::UInt32 &&
+                     (VarType) v->type != VarType::Int32 &&
+                     (VarType) v->type != VarType::Float32))
+            jitc_raise("jit_var_sort(): values must be a 32-bit array!");
+        if (unlikely(v->size != size || v->backend != k->backend))
+            jitc_raise("jit_var_sort(): incompatible keys and values!");
+        if (unlikely(!values_out))
+            jitc_raise("jit_var_sort(): 'values_out' must be specified!");
+    }
+
+    int rv;
+    Ref keys_ev = steal(jitc_var_schedule_force(keys, &rv)),
+        values_ev = steal(jitc_var_schedule_force(values, &rv));
+    jitc_eval(thread_state(backend));
+
+    AllocType atype = backend == JitBackend::CUDA ? AllocType::Device
+                                                  : AllocType::HostAsync;
+
+    const void *keys_in = jitc_var(keys_ev)->data;
+    void *keys_data = jitc_malloc(atype, (size_t) size * type_size[(int) vt]);
+    Ref keys_result = steal(jitc_var_mem_map(backend, vt, keys_data, size, 1));
+
+    const uint32_t *values_in = nullptr;
+    uint32_t *values_data = nullptr;
+    Ref values_result;
+
+    if (values) {
+        const Variable *v = jitc_var(values_ev);
+        values_in = (const uint32_t *) v->data;
+        values_data = (uint32_t *) jitc_malloc(atype, (size_t) size * sizeof(uint32_t));
+        values_result = steal(jitc_var_mem_map(backend, (VarType) v->type,
+                                               values_data, size, 1));
+    }
+
+    jitc_sort(backend, vt, size, keys_in, values_in, keys_data, values_data);
+
+    *keys_out = keys_result.release();
+    if (values_out)
+        *values_out = values_result.release();
+}
+
+uint32_t jitc_var_histogram(uint32_t values, uint32_t bin_count,
+                            uint32_t weights) {
+    if (!values)
+        return 0;
+
+    const Variable *v = jitc_var(values);
+    JitBackend backend = (JitBackend) v->backend;
+    uint32_t size = v->size;
+    VarType vt = VarType::UInt32;
+
+    if (unlikely((VarType) v->type != VarType::UInt32 &&
+                 (VarType) v->type != VarType::Int32))
+        jitc_raise("jit_var_histogram(): values must be a 32-bit integer array!");
+    if (unlikely(bin_count == 0))
+        jitc_raise("jit_var_histogram(): bin_count cannot be zero!");
+
+    if (weights) {
+        const Variable *w = jitc_var(weights);
+        vt = (VarType) w->type;
+        if (unlikely(w->size != size || w->backend != v->backend))
+            jitc_raise("jit_var_histogram(): incompatible values and weights!");
+    }
+
+    int rv;
+    Ref values_ev = steal(jitc_var_schedule_force(values, &rv)),
+        weights_ev = steal(jitc_var_schedule_force(weights, &rv));
+    jitc_eval(thread_state(backend));
+
+    AllocType atype = backend == JitBackend::CUDA ? AllocType::Device
+                                                  : AllocType::HostAsync;
+
+    void *out = jitc_malloc(atype, (size_t) bin_count * type_size[(int) vt]);
+    Ref result = steal(jitc_var_mem_map(backend, vt, out, bin_count, 1));
+
+    jitc_histogram(backend, vt, size, (const uint32_t *) jitc_var(values_ev)->data,
+                   weights ? jitc_var(weights_ev)->data : nullptr, bin_count,
+                   out);
+
+    return result.release();
+}
+
 template <typename T> static void jitc_var_reduce_scalar_add(uint32_t size, void *ptr) {
     T value;
     memcpy(&value, ptr, sizeof(T));
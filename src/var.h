@@ -150,8 +150,13 @@ extern void jitc_var_read(uint32_t index, size_t offset, void *dst);
 /// Reverse of jitc_var_read(). Copy 'src' to a single element of a variable
 extern uint32_t jitc_var_write(uint32_t index, size_t offset, const void *src);
 
-/// Schedule a variable \c index for future evaluation via \ref jit_eval()
-extern int jitc_var_schedule(uint32_t index);
+/**
+ * \brief Schedule a variable \c index for future evaluation via \ref jit_eval()
+ *
+ * When \c deferrable is set, the cost model of \ref jit_eval() may decide to
+ * leave the variable unevaluated (see \ref JitFlag::EvalCostModel).
+ */
+extern int jitc_var_schedule(uint32_t index, bool deferrable = false);
 
 /// More aggressive version of the above function
 extern uint32_t jitc_var_schedule_force(uint32_t index, int *rv);
@@ -268,6 +273,14 @@ extern uint32_t jitc_var_shrink(uint32_t index, size_t size);
 /// Compress a sparse boolean array into an index array of the active indices
 extern uint32_t jitc_var_compress(uint32_t index);
 
+/// Stable sort of an array of keys and (optionally) of associated values
+extern void jitc_var_sort(uint32_t keys, uint32_t values, uint32_t *keys_out,
+                          uint32_t *values_out);
+
+/// Accumulate (optionally weighted) entries of an index array into bins
+extern uint32_t jitc_var_histogram(uint32_t values, uint32_t bin_count,
+                                   uint32_t weights);
+
 /// Temporarily stash the reference count of a variable used to make
 /// copy-on-write (COW) decisions in jit_var_scatter. Returns a handle for
 /// \ref jitc_var_unstash_ref().
@@ -7,6 +7,13 @@
 #include <cmath>
 #include <cstring>
 #include <typeinfo>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <limits>
 
 TEST_BOTH(01_creation_destruction_cse) {
     // Test CSE involving normal and evaluated constant literals
@@ -649,3 +656,767 @@ TEST_BOTH_FLOAT_AGNOSTIC(07_and_or_mixed) {
         }
     }
 }
+
+TEST_BOTH_FLOAT_AGNOSTIC(08_op_batch) {
+    // Tests the construction of an expression via jit_var_op_batch()
+    // that is equivalent to the separate version: (a * b + 3) * c
+    float a_v[] = { 1.f, 2.f, 3.f, 4.f },
+          b_v[] = { 5.f, 6.f, 7.f, 8.f },
+          c_v[] = { -1.f, 1.f, -2.f, 2.f };
+
+    uint32_t a = jit_var_mem_copy(Backend, AllocType::Host, VarType::Float32, a_v, 4),
+             b = jit_var_mem_copy(Backend, AllocType::Host, VarType::Float32, b_v, 4),
+             c = jit_var_mem_copy(Backend, AllocType::Host, VarType::Float32, c_v, 4);
+
+    float three = 3.f;
+    uint64_t three_u64 = 0;
+    memcpy(&three_u64, &three, sizeof(float));
+
+    uint32_t in[3] = { a, b, c };
+    JitBatchOp ops[4] = {
+        { JitOp::Mul,   VarType::Void,    { 0, 1, 0 }, 0 },        // 3: a * b
+        { JitOp::Count, VarType::Float32, { 0, 0, 0 }, three_u64 },// 4: 3
+        { JitOp::Add,   VarType::Void,    { 3, 4, 0 }, 0 },        // 5: (3) + (4)
+        { JitOp::Mul,   VarType::Void,    { 5, 2, 0 }, 0 }         // 6: (5) * c
+    };
+
+    uint32_t result = jit_var_op_batch(Backend, in, 3, ops, 4);
+
+    float out[4];
+    jit_var_eval(result);
+    for (uint32_t i = 0; i < 4; ++i) {
+        jit_var_read(result, i, out + i);
+        jit_assert(out[i] == (a_v[i] * b_v[i] + 3.f) * c_v[i]);
+    }
+
+    // Referencing a slot that has not been defined yet should fail
+    bool raised = false;
+    try {
+        JitBatchOp bad = { JitOp::Add, VarType::Void, { 0, 3, 0 }, 0 };
+        jit_var_op_batch(Backend, in, 3, &bad, 1);
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    jit_assert(raised);
+
+    jit_var_dec_ref(result);
+    jit_var_dec_ref(a);
+    jit_var_dec_ref(b);
+    jit_var_dec_ref(c);
+}
+
+TEST_LLVM(09_single_threaded) {
+    // Tracing and evaluation with lock elision enabled
+    jit_set_single_threaded(1);
+    jit_assert(jit_single_threaded() == 1);
+
+    UInt32 x = arange<UInt32>(10);
+    for (int i = 0; i < 10; ++i)
+        x = x * 2u + 1u;
+    x.eval();
+    jit_assert(x.read(1) == 2047u);
+
+    jit_set_single_threaded(0);
+    jit_assert(jit_single_threaded() == 0);
+}
+
+TEST_BOTH(10_expr_templates) {
+    // Expression templates evaluate to the same result as the eager version
+    Float a = arange<Float>(10), b = a * 2.f + 1.f, c = b - 3.f;
+    Float r1 = lazy(a) * b + 3.f,
+          r2 = fmadd(lazy(a), b, c) / 2.f,
+          r3 = select(lazy(a) > 4.f, -(-lazy(b)), sqrt(lazy(a)));
+    Float r1_ref = a * b + 3.f,
+          r2_ref = fmadd(a, b, c) / 2.f,
+          r3_ref = select(a > 4.f, b, sqrt(a));
+    jit_assert(all(eq(r1, r1_ref)));
+    jit_assert(all(eq(r2, r2_ref)));
+    jit_assert(all(eq(r3, r3_ref)));
+
+    // Integer constants are reassociated at compile time
+    UInt32 x = arange<UInt32>(10);
+    static_assert(decltype(lazy(x) * 3u * 5u)::Ops == 2,
+                  "Constants were not folded!");
+    UInt32 y = (lazy(x) + 1u + 2u) * 3u * 5u,
+           y_ref = (x + 3u) * 15u;
+    jit_assert(all(eq(y, y_ref)));
+
+    // Assignment to an existing array
+    y = lazy(y) - x;
+    jit_assert(y.read(2) == 73u);
+}
+
+TEST_BOTH(11_kernel_split) {
+    // Evaluate a long computation with many live intermediate values, once
+    // as a single kernel and once split into several smaller kernels
+    uint32_t threshold = jit_kernel_split_threshold();
+    UInt32 ref[2];
+
+    for (int split = 0; split < 2; ++split) {
+        jit_set_kernel_split_threshold(split ? 16 : 0);
+
+        UInt32 x = arange<UInt32>(100), y = x + 1u, z = x * 3u;
+        UInt32 buf = zeros<UInt32>(100);
+        for (uint32_t i = 0; i < 20; ++i) {
+            y = y * 3u + z;
+            z = (z ^ y) + i;
+            if (i == 10)
+                scatter(buf, y, x);
+        }
+        UInt32 r = gather<UInt32>(buf, x) + y * z;
+        r.eval();
+        ref[split] = r;
+    }
+
+    jit_set_kernel_split_threshold(threshold);
+    jit_assert(all(eq(ref[0], ref[1])));
+}
+
+TEST_BOTH(12_eval_cost_model) {
+    // Cheap scheduled expressions are recomputed, while expensive
+    // intermediates that remain referenced are stored
+    uint32_t flags = jit_flags();
+    jit_set_flag(JitFlag::EvalCostModel, 1);
+
+    UInt32 a = arange<UInt32>(10);
+    UInt32 x = a + 1u;
+    x.schedule();
+    jit_eval();
+    jit_assert(jit_var_state(x.index()) != VarState::Evaluated);
+    jit_assert(x.read(3) == 4u);
+
+    UInt32 y = a;
+    for (uint32_t i = 0; i < 5; ++i)
+        y = (y * 3u) ^ (y + i);
+    UInt32 z = y + 1u;
+    z.eval();
+    jit_assert(jit_var_state(y.index()) == VarState::Evaluated);
+    jit_assert(jit_var_state(z.index()) == VarState::Evaluated);
+    jit_assert(all(eq(z, y + 1u)));
+
+    // A forced schedule is not downgraded by a later deferrable one
+    int rv = 0;
+    UInt32 w = UInt32::steal(jit_var_schedule_force((a + 2u).index(), &rv));
+    jit_assert(rv == 1);
+    w.schedule();
+    jit_eval();
+    jit_assert(jit_var_state(w.index()) == VarState::Evaluated);
+    jit_assert(w.read(3) == 5u);
+
+    jit_set_flags(flags);
+}
+
+TEST_LLVM(13_concurrent_eval) {
+    /* Evaluation is serialized, but threads may trace while another one
+       compiles a kernel. Value numbering shares the literals and 'x' */
+    constexpr uint32_t n_threads = 4;
+    bool success[n_threads] { };
+    std::thread threads[n_threads];
+
+    for (uint32_t t = 0; t < n_threads; ++t) {
+        threads[t] = std::thread([t, &success]() {
+            bool ok = true;
+            for (uint32_t k = 0; k < 10; ++k) {
+                UInt32 x = arange<UInt32>(1000);
+                UInt32 y = x * (t + 2) + k;
+                y.eval();
+                ok &= y.read(999) == 999 * (t + 2) + k;
+            }
+            success[t] = ok;
+        });
+    }
+
+    for (uint32_t t = 0; t < n_threads; ++t) {
+        threads[t].join();
+        jit_assert(success[t]);
+    }
+}
+
+TEST_LLVM(14_priority) {
+    // A high-priority thread uses a separate task chain and thread pool,
+    // while a normal-priority thread keeps using the shared one
+    bool success = false;
+    std::thread background([&success]() {
+        bool ok = true;
+        for (uint32_t k = 0; k < 10; ++k) {
+            UInt32 x = arange<UInt32>(100000) * 3u + k;
+            x.eval();
+            ok &= x.read(99999) == 99999u * 3u + k;
+        }
+        success = ok;
+    });
+
+    jit_llvm_set_priority(JitPriority::High);
+    jit_assert(jit_llvm_priority() == JitPriority::High);
+    for (uint32_t k = 0; k < 10; ++k) {
+        UInt32 y = arange<UInt32>(1000) + k;
+        y.eval();
+        jit_assert(y.read(999) == 999u + k);
+    }
+    jit_llvm_set_priority(JitPriority::Normal);
+    jit_assert(jit_llvm_priority() == JitPriority::Normal);
+
+    background.join();
+    jit_assert(success);
+}
+
+TEST_LLVM(15_cancel) {
+    // A cancelled computation raises an exception at the next
+    // synchronization, after which the thread state is usable again
+    void *token = jit_cancel_token();
+    jit_assert(token != nullptr);
+
+    UInt32 x = arange<UInt32>(1000) * 2u;
+    jit_cancel(token);
+    x.eval();
+
+    bool raised = false;
+    try {
+        jit_sync_thread();
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    jit_assert(raised);
+
+    // The output of the cancelled kernel was released
+    jit_assert(jit_var_state(x.index()) == VarState::Invalid);
+    raised = false;
+    try {
+        x.read(0);
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    jit_assert(raised);
+
+    raised = false;
+    try {
+        (x + 1u).eval();
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    jit_assert(raised);
+
+    UInt32 y = arange<UInt32>(1000) * 2u + 1u;
+    jit_assert(y.read(999) == 1999u);
+
+    // A request without pending computation is reported and cleared as well
+    jit_sync_thread();
+    jit_cancel(token);
+    raised = false;
+    try {
+        jit_sync_thread();
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    jit_assert(raised);
+    jit_assert((y + 1u).read(999) == 2000u);
+
+    // Parallel primitives observe the request, too. Synchronizing first
+    // ensures that 'm' is not released along with the cancelled computation
+    Mask m = eq(y % 3u, 0u);
+    m.eval();
+    jit_sync_thread();
+    jit_cancel(token);
+    raised = false;
+    try {
+        UInt32::steal(jit_var_compress(m.index()));
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    jit_assert(raised);
+    jit_assert(jit_var_size(UInt32::steal(jit_var_compress(m.index())).index()) == 333);
+}
+
+TEST_BOTH(16_pipelined_split) {
+    // The parts of a split elementwise kernel are pipelined block by block
+    uint32_t threshold = jit_kernel_split_threshold();
+    UInt32 ref[2];
+
+    for (int split = 0; split < 2; ++split) {
+        jit_set_kernel_split_threshold(split ? 16 : 0);
+
+        UInt32 x = arange<UInt32>(100000), y = x + 1u, z = x * 3u;
+        for (uint32_t i = 0; i < 20; ++i) {
+            y = y * 3u + z;
+            z = (z ^ y) + i;
+        }
+        UInt32 r = y * z;
+        r.eval();
+        ref[split] = r;
+    }
+
+    jit_set_kernel_split_threshold(threshold);
+    jit_assert(all(eq(ref[0], ref[1])));
+}
+
+TEST_LLVM(17_nontemporal_threshold) {
+    // Kernels with temporal and non-temporal memory accesses compute the
+    // same result
+    size_t threshold = jit_llvm_nontemporal_threshold();
+    UInt32 ref[2];
+
+    for (int i = 0; i < 2; ++i) {
+        jit_llvm_set_nontemporal_threshold(i ? 0 : threshold);
+        UInt32 x = arange<UInt32>(10000);
+        x.eval();
+        UInt32 y = x * x + 3u;
+        y.eval();
+        ref[i] = y;
+    }
+
+    jit_llvm_set_nontemporal_threshold(threshold);
+    jit_assert(all(eq(ref[0], ref[1])));
+    jit_assert(ref[0].read(100) == 10003u);
+}
+
+TEST_LLVM(18_peeled_remainder) {
+    // Kernels that process full packets without a mask and the remaining
+    // lanes in a masked epilogue handle all sizes correctly. Small launches
+    // are not peeled.
+    for (uint32_t size : { 1u, 3u, 7u, 16u, 17u, 63u, 64u, 65u, 1001u, 4099u }) {
+        UInt32 x = arange<UInt32>(size),
+               y = gather<UInt32>(x, UInt32(size - 1) - x) * 2u;
+        UInt32 buf = zeros<UInt32>(size + 1);
+        scatter_reduce(ReduceOp::Add, buf, UInt32(1), x);
+        scatter(buf, y, x + 1u);
+        y.eval();
+        buf.eval();
+
+        for (uint32_t i = 0; i < size; ++i) {
+            jit_assert(y.read(i) == 2 * (size - 1 - i));
+            jit_assert(buf.read(i + 1) == 2 * (size - 1 - i));
+        }
+        jit_assert(buf.read(0) == 1u);
+    }
+}
+
+template <typename Array, typename Func>
+void check_math(uint32_t (*op)(uint32_t), Func ref, double min, double max,
+                double tol) {
+    uint32_t n = 1001;
+    Array x = linspace<Array>((typename Array::Value) min,
+                              (typename Array::Value) max, n);
+    Array y = Array::steal(op(x.index()));
+    y.eval();
+
+    for (uint32_t i = 0; i < n; ++i) {
+        double xi = (double) x.read(i), yi = (double) y.read(i),
+               ri = ref(xi);
+        jit_assert(std::abs(yi - ri) <= tol * std::max(1.0, std::abs(ri)));
+    }
+}
+
+/// Compare against 'ref' for 2^16 arguments with exponents in [-10, max_exp]
+template <typename Array, typename Func>
+double max_math_error(uint32_t (*op)(uint32_t), Func ref, int max_exp) {
+    using Value = typename Array::Value;
+    uint32_t n = 1 << 16;
+    std::vector<Value> data(n);
+    uint64_t state = 0x853c49e6748fea9bull;
+    for (uint32_t i = 0; i < n; ++i) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        double u = (double) (state >> 11) * 0x1p-53,
+               e = -10.0 + u * (max_exp + 10.0);
+        data[i] = (Value) ((i & 1 ? -1.0 : 1.0) * std::exp2(e));
+    }
+
+    Array x = Array::copy(data.data(), n),
+          y = Array::steal(op(x.index()));
+    y.eval();
+
+    // Error in multiples of the machine epsilon relative to the result
+    double err = 0.0, eps = std::numeric_limits<Value>::epsilon();
+    for (uint32_t i = 0; i < n; ++i) {
+        double yi = (double) y.read(i), ri = ref((double) data[i]);
+        err = std::max(err, std::abs(yi - ri) /
+                                (eps * std::max(std::abs(ri), 1e-3)));
+    }
+    return err;
+}
+
+TEST_LLVM(19_math_intrinsics) {
+    // Vectorized transcendental functions are accurate in both accuracy tiers
+    using Float32 = typename Float::template ReplaceValue<float>;
+    using Float64 = typename Float::template ReplaceValue<double>;
+    uint32_t flags = jit_flags();
+
+    for (int fast = 0; fast < 2; ++fast) {
+        jit_set_flag(JitFlag::FastMath, fast);
+        double tol32 = fast ? 4e-6 : 1e-6, tol64 = fast ? 1e-13 : 1e-14;
+
+        auto sin_ = [](double x) { return std::sin(x); };
+        auto cos_ = [](double x) { return std::cos(x); };
+        auto exp2_ = [](double x) { return std::exp2(x); };
+        auto log2_ = [](double x) { return std::log2(x); };
+
+        check_math<Float32>(jit_var_sin_intrinsic, sin_, -20, 20, tol32);
+        check_math<Float32>(jit_var_cos_intrinsic, cos_, -20, 20, tol32);
+        check_math<Float32>(jit_var_exp2_intrinsic, exp2_, -20, 20, tol32);
+        check_math<Float32>(jit_var_log2_intrinsic, log2_, 1e-3, 1e3, tol32);
+        check_math<Float64>(jit_var_sin_intrinsic, sin_, -20, 20, tol64);
+        check_math<Float64>(jit_var_cos_intrinsic, cos_, -20, 20, tol64);
+        check_math<Float64>(jit_var_exp2_intrinsic, exp2_, -20, 20, tol64);
+        check_math<Float64>(jit_var_log2_intrinsic, log2_, 1e-3, 1e3, tol64);
+
+        // Special values
+        Float32 x = linspace<Float32>(-200.f, 200.f, 3), z = x * 0.f;
+        make_opaque(x, z);
+        Float32 e = Float32::steal(jit_var_exp2_intrinsic(x.index())),
+                l = Float32::steal(jit_var_log2_intrinsic(x.index())),
+                lz = Float32::steal(jit_var_log2_intrinsic(z.index()));
+        jit_assert(e.read(0) == 0.f && e.read(1) == 1.f &&
+                   std::isinf(e.read(2)));
+        jit_assert(std::isnan(l.read(0)) && std::isinf(lz.read(1)) &&
+                   lz.read(1) < 0);
+        jit_assert(std::abs(l.read(2) - std::log2(200.f)) < 1e-5f);
+
+        // Sin/Cos remain accurate up to the largest finite arguments
+        double tol = fast ? 32.0 : 3.0;
+        jit_assert(max_math_error<Float32>(jit_var_sin_intrinsic, sin_, 127) <= tol);
+        jit_assert(max_math_error<Float32>(jit_var_cos_intrinsic, cos_, 127) <= tol);
+        jit_assert(max_math_error<Float64>(jit_var_sin_intrinsic, sin_, 1023) <= tol);
+        jit_assert(max_math_error<Float64>(jit_var_cos_intrinsic, cos_, 1023) <= tol);
+    }
+
+    jit_set_flags(flags);
+}
+
+template <typename UInt32, typename Array>
+void check_searchsorted(const std::vector<typename Array::Value> &data) {
+    using Value = typename Array::Value;
+    Array source = Array::copy(data.data(), data.size());
+
+    std::vector<Value> queries;
+    for (int i = -2; i < 2 * (int) data.size() + 4; ++i)
+        queries.push_back((Value) i);
+    Array value = Array::copy(queries.data(), queries.size());
+
+    for (int right = 0; right < 2; ++right) {
+        UInt32 r = UInt32::steal(
+            jit_var_searchsorted(source.index(), value.index(), right));
+        r.eval();
+
+        for (size_t i = 0; i < queries.size(); ++i) {
+            auto it = right ? std::upper_bound(data.begin(), data.end(), queries[i])
+                            : std::lower_bound(data.begin(), data.end(), queries[i]);
+            jit_assert(r.read((uint32_t) i) == (uint32_t) (it - data.begin()));
+        }
+    }
+}
+
+TEST_LLVM(20_searchsorted) {
+    // Branch-free binary search matches std::lower_bound/std::upper_bound
+    using Float32 = typename Float::template ReplaceValue<float>;
+    using Float64 = typename Float::template ReplaceValue<double>;
+
+    for (uint32_t size : { 1u, 2u, 5u, 16u, 1000u }) {
+        std::vector<int32_t> vi;
+        std::vector<float> vf;
+        std::vector<double> vd;
+        for (uint32_t i = 0; i < size; ++i) {
+            int32_t value = (int32_t) (i / 2) * 3 - 1;
+            vi.push_back(value);
+            vf.push_back((float) value);
+            vd.push_back((double) value);
+        }
+        check_searchsorted<UInt32, Int32>(vi);
+        check_searchsorted<UInt32, Float32>(vf);
+        check_searchsorted<UInt32, Float64>(vd);
+    }
+
+    // Searching an array for its own entries yields their (upper) positions
+    Float32 x = arange<Float32>(5);
+    UInt32 r = UInt32::steal(jit_var_searchsorted(x.index(), x.index(), 1));
+    jit_assert(r.read(0) == 1u && r.read(4) == 5u);
+}
+
+/// Scalar reference implementation of Philox2x32-10
+static uint64_t philox2x32_10(uint32_t c0, uint32_t c1, uint32_t k) {
+    for (int i = 0; i < 10; ++i) {
+        uint64_t p = (uint64_t) c0 * 0xD256D345u;
+        c0 = (uint32_t) (p >> 32) ^ k ^ c1;
+        c1 = (uint32_t) p;
+        k += 0x9E3779B9u;
+    }
+    return ((uint64_t) c1 << 32) | c0;
+}
+
+TEST_LLVM(21_philox) {
+    // The vectorized generator matches a scalar reference implementation
+    using UInt64 = typename UInt32::template ReplaceValue<uint64_t>;
+    using Float32 = typename Float::template ReplaceValue<float>;
+    using Float64 = typename Float::template ReplaceValue<double>;
+
+    uint32_t n = 1001;
+    UInt32 counter = UInt32::steal(jit_var_counter(Backend, n)),
+           stream(3u), seed(0x13198a2eu);
+
+    UInt64 r64 = UInt64::steal(jit_var_philox(VarType::UInt64, counter.index(),
+                                              stream.index(), seed.index()));
+    UInt32 r32 = UInt32::steal(jit_var_philox(VarType::UInt32, counter.index(),
+                                              stream.index(), seed.index()));
+    Float32 f32 = Float32::steal(jit_var_philox(VarType::Float32, counter.index(),
+                                                stream.index(), seed.index()));
+    Float64 f64 = Float64::steal(jit_var_philox(VarType::Float64, counter.index(),
+                                                stream.index(), seed.index()));
+    jit_var_schedule(r32.index());
+    jit_var_schedule(f32.index());
+    jit_var_schedule(f64.index());
+    r64.eval();
+
+    for (uint32_t i = 0; i < n; ++i) {
+        uint64_t ref = philox2x32_10(i, 3u, 0x13198a2eu);
+        jit_assert(r64.read(i) == ref);
+        jit_assert(r32.read(i) == (uint32_t) ref);
+        jit_assert(f32.read(i) == (float) ((uint32_t) ref >> 8) * 0x1p-24f);
+        jit_assert(f64.read(i) == (double) (ref >> 11) * 0x1p-53);
+    }
+
+    // The result does not depend on how the evaluation is split up
+    UInt32 part = UInt32::steal(jit_var_philox(
+        VarType::UInt32, (counter + 500u).index(), stream.index(), seed.index()));
+    jit_assert(part.read(0) == r32.read(500));
+}
+
+TEST_LLVM(22_lazy_views) {
+    // Tiled, repeated, and reversed arrays are correct when consumed directly
+    // by a kernel (possibly using vector loads) and when folded into a gather
+    for (uint32_t n : { 1u, 5u, 64u, 128u }) {
+        for (uint32_t count : { 1u, 3u, 64u }) {
+            UInt32 x = arange<UInt32>(n) * 3u + 1u;
+            x.eval();
+
+            UInt32 t = tile(x, count) + 1u,
+                   r = repeat(x, count) + 1u,
+                   v = UInt32::steal(jit_var_reverse(x.index())) + 1u,
+                   i = arange<UInt32>(n * count) / 2u,
+                   tg = gather<UInt32>(tile(x, count), i),
+                   rg = gather<UInt32>(repeat(x, count), i);
+            jit_var_schedule(t.index());
+            jit_var_schedule(r.index());
+            jit_var_schedule(v.index());
+            jit_var_schedule(tg.index());
+            rg.eval();
+
+            for (uint32_t j = 0; j < n * count; ++j) {
+                jit_assert(t.read(j) == (j % n) * 3u + 2u);
+                jit_assert(r.read(j) == (j / count) * 3u + 2u);
+                jit_assert(tg.read(j) == ((j / 2) % n) * 3u + 1u);
+                jit_assert(rg.read(j) == ((j / 2) / count) * 3u + 1u);
+            }
+
+            for (uint32_t j = 0; j < n; ++j)
+                jit_assert(v.read(j) == (n - 1 - j) * 3u + 2u);
+        }
+    }
+}
+
+TEST_LLVM(23_code_arena) {
+    // Compile many distinct kernels that share executable memory, evict
+    // them, and then load them again from the on-disk kernel cache
+    for (int pass = 0; pass < 2; ++pass) {
+        for (uint32_t i = 0; i < 50; ++i) {
+            UInt32 x = arange<UInt32>(100) * (i + 1000u) + i;
+            x.eval();
+            for (uint32_t j = 0; j < 100; j += 33)
+                jit_assert(x.read(j) == j * (i + 1000u) + i);
+        }
+        jit_flush_kernel_cache();
+    }
+}
+
+TEST_BOTH(24_cond_compact) {
+    jit_set_flag(JitFlag::CompactConditionals, 1);
+
+    constexpr uint32_t n = 1000;
+    UInt32 x = arange<UInt32>(n);
+    Mask cond = eq(x % UInt32(10), 0);
+
+    uint32_t index_t, index_f;
+    jit_var_cond_compact("test", cond.index(), (!cond).index(), &index_t,
+                         &index_f);
+    UInt32 idx_t = UInt32::steal(index_t);
+    Mask mask_f = Mask::steal(index_f);
+
+    // The rarely taken branch runs on a compacted subset of the lanes
+    jit_assert(jit_var_type(index_t) == VarType::UInt32 &&
+               jit_var_size(index_t) == n / 10);
+    jit_assert(jit_var_type(index_f) == VarType::Bool);
+
+    UInt32 result = select(mask_f, x + UInt32(1), UInt32(0));
+    UInt32 x_t = gather(x, idx_t);
+    scatter(result, x_t * UInt32(2), idx_t);
+
+    UInt32 ref = select(cond, x * UInt32(2), x + UInt32(1));
+    jit_assert(all(eq(result, ref)));
+
+    // Branches that no lane takes are skipped, others run masked when
+    // compaction is disabled
+    jit_set_flag(JitFlag::CompactConditionals, 0);
+    Mask none = Mask(false);
+    jit_var_cond_compact("test", cond.index(), none.index(), &index_t,
+                         &index_f);
+    jit_assert(index_f == 0 && jit_var_type(index_t) == VarType::Bool);
+    jit_var_dec_ref(index_t);
+    jit_set_flag(JitFlag::CompactConditionals, 1);
+
+    // Scalar masks are broadcast rather than compressed to a single lane
+    Mask all_true = Mask(true);
+    jit_var_cond_compact("test", all_true.index(), cond.index(), &index_t,
+                         &index_f);
+    jit_assert(jit_var_type(index_t) == VarType::Bool &&
+               jit_var_size(index_t) == n);
+    jit_assert(jit_var_type(index_f) == VarType::UInt32 &&
+               jit_var_size(index_f) == n / 10);
+    jit_var_dec_ref(index_t);
+    jit_var_dec_ref(index_f);
+
+    // .. and zero-valued masks denote branches that no lane takes
+    jit_var_cond_compact("test", 0, cond.index(), &index_t, &index_f);
+    jit_assert(index_t == 0 && jit_var_size(index_f) == n / 10);
+    jit_var_dec_ref(index_f);
+
+    jit_set_flag(JitFlag::CompactConditionals, 0);
+}
+
+TEST_LLVM(25_portable_cache) {
+    std::string cpu = jit_llvm_target_cpu();
+    uint32_t width = jit_llvm_vector_width();
+
+    jit_llvm_set_portable(1, 1);
+    uint32_t level = jit_llvm_isa_level();
+    if (level) {
+        jit_assert(strcmp(jit_llvm_target_cpu(),
+                          level == 4 ? "x86-64-v4" : "x86-64-v3") == 0);
+        jit_assert(jit_llvm_vector_width() == (level == 4 ? 16u : 8u));
+    }
+
+    // Compiling a kernel also adds the variant of the other level to the cache
+    auto run = []() {
+        Float x = linspace<Float>(0.f, 1.f, 100) + Float(3.f);
+        x = fmadd(x, x, Float(1.f));
+        jit_assert(x.read(0) == 10.f);
+        jit_flush_kernel_cache();
+    };
+    run();
+
+    // .. which is loaded from disk after switching to the other level
+    if (level == 4) {
+        jit_llvm_set_portable(3);
+        jit_assert(jit_llvm_isa_level() == 3 && jit_llvm_vector_width() == 8u);
+
+        jit_set_flag(JitFlag::KernelHistory, true);
+        run();
+        jit_set_flag(JitFlag::KernelHistory, false);
+
+        uint32_t disk_hits = 0;
+        KernelHistoryEntry *data = jit_kernel_history();
+        for (KernelHistoryEntry *e = data; e && (uint32_t) e->backend; ++e) {
+            if (e->type == KernelType::JIT)
+                disk_hits += e->cache_disk;
+            free(e->ir);
+        }
+        free(data);
+        jit_assert(disk_hits == 1);
+    }
+
+    jit_llvm_set_portable(0);
+    jit_assert(jit_llvm_isa_level() == 0 && cpu == jit_llvm_target_cpu() &&
+               jit_llvm_vector_width() == width);
+}
+
+TEST_BOTH(26_interned_labels) {
+    jit_prefix_push(Backend, "scope");
+    UInt32 a = arange<UInt32>(10), b = arange<UInt32>(20);
+    set_label(a, "x");
+    set_label(b, "x");
+    jit_prefix_pop(Backend);
+
+    // Identical labels are stored once
+    jit_assert(strcmp(jit_var_label(a.index()), "x") == 0);
+    jit_assert(jit_var_label(a.index()) == jit_var_label(b.index()));
+
+    // Relabeling releases the previous string
+    set_label(a, "y");
+    jit_assert(strcmp(jit_var_label(a.index()), "y") == 0 &&
+               strcmp(jit_var_label(b.index()), "x") == 0);
+}
+
+TEST_LLVM(27_priority_order) {
+    // Normal-priority work that is submitted while high-priority work is
+    // still pending runs after it
+    struct Context {
+        std::mutex mutex;
+        std::vector<int> events;
+        std::atomic<bool> high_ready { false }, normal_ready { false };
+    } ctx;
+
+    jit_assert(jit_llvm_priority_thread_count() >= 1);
+
+    std::thread high([&ctx]() {
+        jit_llvm_set_priority(JitPriority::High);
+        UInt32 y = arange<UInt32>(100000) + 1u;
+        y.eval();
+        jit_enqueue_host_func(JitBackend::LLVM, [](void *p) {
+            Context *ctx = (Context *) p;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            std::lock_guard<std::mutex> guard(ctx->mutex);
+            ctx->events.push_back(1);
+        }, &ctx);
+        ctx.high_ready = true;
+        while (!ctx.normal_ready)
+            std::this_thread::yield();
+        jit_sync_thread();
+        jit_llvm_set_priority(JitPriority::Normal);
+    });
+
+    while (!ctx.high_ready)
+        std::this_thread::yield();
+
+    UInt32 x = arange<UInt32>(1000) * 2u;
+    x.eval();
+    jit_enqueue_host_func(JitBackend::LLVM, [](void *p) {
+        Context *ctx = (Context *) p;
+        std::lock_guard<std::mutex> guard(ctx->mutex);
+        ctx->events.push_back(2);
+    }, &ctx);
+    ctx.normal_ready = true;
+    jit_sync_thread();
+    high.join();
+
+    jit_assert(ctx.events.size() == 2 && ctx.events[0] == 1 &&
+               ctx.events[1] == 2);
+    jit_assert(x.read(999) == 1998u);
+}
+
+TEST_LLVM(28_nontemporal_recompile) {
+    // The size-dependent choice of memory accesses is part of the kernel
+    // hash, hence crossing the threshold produces a separate kernel
+    size_t threshold = jit_llvm_nontemporal_threshold();
+    jit_llvm_set_nontemporal_threshold(4000);
+
+    uint32_t sizes[4] = { 100, 200, 2000, 3000 };
+    uint64_t hash[4] { };
+
+    for (int i = 0; i < 4; ++i) {
+        UInt32 x = arange<UInt32>(sizes[i]);
+        x.eval();
+
+        jit_set_flag(JitFlag::KernelHistory, true);
+        UInt32 y = x * x + 3u;
+        y.eval();
+        jit_set_flag(JitFlag::KernelHistory, false);
+        jit_assert(y.read(10) == 103u);
+
+        KernelHistoryEntry *data = jit_kernel_history();
+        for (KernelHistoryEntry *e = data; e && (uint32_t) e->backend; ++e) {
+            if (e->type == KernelType::JIT)
+                hash[i] = e->hash[0];
+            free(e->ir);
+        }
+        free(data);
+    }
+
+    jit_llvm_set_nontemporal_threshold(threshold);
+    jit_assert(hash[0] == hash[1] && hash[2] == hash[3] && hash[0] != hash[2]);
+}
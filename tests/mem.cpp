@@ -1,6 +1,7 @@
 #include "test.h"
 #include <cstring>
 #include <algorithm>
+#include <vector>
 
 TEST_BOTH_FLOAT_AGNOSTIC(01_gather) {
     Int32 r = arange<Int32>(100) + 100;
@@ -325,3 +326,105 @@ TEST_BOTH(18_scatter_inc_mask) {
     UInt32 arbitrary = scatter_inc(counter, idx, all_false);
     jit_assert(jit_var_size(arbitrary.index()) == 7);
 }
+
+template <typename T, template <class> class Array>
+void test_scatter_reduce_conflict(ReduceOp op) {
+    using Index = Array<uint32_t>;
+    using Bool = Array<bool>;
+
+    constexpr size_t n = 1000, m = 7;
+    T value_cpu[n], target_cpu[m], out_cpu[m];
+    uint32_t index_cpu[n];
+    bool mask_cpu[n];
+
+    for (size_t i = 0; i < m; ++i)
+        target_cpu[i] = T(3 + i);
+
+    for (size_t i = 0; i < n; ++i) {
+        // Long runs of identical indices as well as scattered conflicts
+        index_cpu[i] = (uint32_t) (i < 200 ? (i / 50) : (i * 13) % m);
+        value_cpu[i] = T((i * 5) % 11);
+        mask_cpu[i] = (i % 7) != 3;
+
+        if (!mask_cpu[i])
+            continue;
+
+        T &t = target_cpu[index_cpu[i]], v = value_cpu[i];
+        switch (op) {
+            case ReduceOp::Add: t = t + v; break;
+            case ReduceOp::Min: t = std::min(t, v); break;
+            case ReduceOp::Max: t = std::max(t, v); break;
+            case ReduceOp::Or: t = T((uint64_t) t | (uint64_t) v); break;
+            default: abort();
+        }
+    }
+
+    Array<T> target = arange<Array<T>>(m) + Array<T>(T(3)),
+             value = Array<T>::copy(value_cpu, n);
+    Index index = Index::copy(index_cpu, n);
+    Bool mask = Bool::copy(mask_cpu, n);
+
+    target = Array<T>::steal(jit_var_scatter(target.index(), value.index(),
+                                             index.index(), mask.index(), op,
+                                             ReduceMode::Conflict));
+    target.eval();
+    jit_memcpy(JitBackend::LLVM, out_cpu, target.data(), m * sizeof(T));
+
+    for (size_t i = 0; i < m; ++i) {
+        if (out_cpu[i] != target_cpu[i]) {
+            printf("%zu: %f vs %f\n", i, (double) out_cpu[i],
+                   (double) target_cpu[i]);
+            abort();
+        }
+    }
+}
+
+TEST_LLVM(19_scatter_reduce_conflict) {
+    ReduceOp ops[] = { ReduceOp::Add, ReduceOp::Min, ReduceOp::Max };
+    for (ReduceOp op : ops) {
+        test_scatter_reduce_conflict<uint32_t, Array>(op);
+        test_scatter_reduce_conflict<int32_t, Array>(op);
+        test_scatter_reduce_conflict<uint64_t, Array>(op);
+        test_scatter_reduce_conflict<float, Array>(op);
+        test_scatter_reduce_conflict<double, Array>(op);
+    }
+    test_scatter_reduce_conflict<uint32_t, Array>(ReduceOp::Or);
+    test_scatter_reduce_conflict<uint64_t, Array>(ReduceOp::Or);
+}
+
+TEST_BOTH(20_scatter_inc_multiple) {
+    // Several counters per packet, interleaved with masked lanes
+    constexpr size_t n = 10000, m = 5;
+    uint32_t out_cpu[n], counter_cpu[m], index_cpu[n];
+    bool active_cpu[n];
+
+    UInt32 counter = zeros<UInt32>(m);
+    UInt32 index = arange<UInt32>(n);
+    Mask active = neq(index % UInt32(7), 3);
+    UInt32 target = (index * UInt32(3)) % UInt32(m);
+
+    UInt32 offset = scatter_inc(counter, target, active);
+    jit_var_schedule(offset.index());
+    jit_var_schedule(target.index());
+    jit_var_schedule(active.index());
+    jit_var_schedule(counter.index());
+    jit_eval();
+
+    jit_memcpy(Backend, out_cpu, offset.data(), n * sizeof(uint32_t));
+    jit_memcpy(Backend, counter_cpu, counter.data(), m * sizeof(uint32_t));
+    jit_memcpy(Backend, index_cpu, target.data(), n * sizeof(uint32_t));
+    jit_memcpy(Backend, active_cpu, active.data(), n * sizeof(bool));
+
+    // Each counter should have handed out a permutation of 0..count-1
+    for (size_t j = 0; j < m; ++j) {
+        std::vector<uint32_t> values;
+        for (size_t i = 0; i < n; ++i) {
+            if (active_cpu[i] && index_cpu[i] == j)
+                values.push_back(out_cpu[i]);
+        }
+        std::sort(values.begin(), values.end());
+        jit_assert(values.size() == counter_cpu[j]);
+        for (size_t i = 0; i < values.size(); ++i)
+            jit_assert(values[i] == i);
+    }
+}
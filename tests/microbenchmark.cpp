@@ -8,6 +8,7 @@
 #include <drjit-core/array.h>
 #include <chrono>
 #include <cstdio>
+#include <cstring>
 
 namespace dr = drjit;
 
@@ -17,9 +18,13 @@ UInt32 collatz(UInt32 x) {
     return select(eq(x & UInt32(1), 0), x / 2, x*3 + 1);
 }
 
-int main(int, char **) {
+int main(int argc, char **argv) {
     jit_init((int) JitBackend::LLVM);
 
+    // Pass '-s' to benchmark the single-threaded mode (no locking)
+    if (argc > 1 && strcmp(argv[1], "-s") == 0)
+        jit_set_single_threaded(1);
+
     using namespace std::chrono;
 
     for (int k = 0; k < 3; ++k) {
@@ -248,3 +248,59 @@ TEST_LLVM(10_scatter) {
         jit_assert(all(eq(y, arange<UInt32>(10 + i) + 1)));
     }
 }
+
+/**
+ * Tests that sorting keys and values inside of a frozen function is recorded
+ * and replayed for inputs of different sizes.
+ */
+TEST_LLVM(11_sort) {
+    auto func = [](UInt32 x, UInt32 v) {
+        uint32_t keys = 0, values = 0;
+        jit_var_sort(x.index(), v.index(), &keys, &values);
+        return std::make_tuple(UInt32::steal(keys), UInt32::steal(values));
+    };
+
+    FrozenFunction frozen(Backend, func);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        UInt32 x = (arange<UInt32>(10 + i) * 7u) % 5u,
+               v = arange<UInt32>(10 + i);
+        make_opaque(x, v);
+
+        auto [keys, values] = frozen(x, v);
+
+        for (uint32_t j = 1; j < 10 + i; ++j) {
+            jit_assert(keys.read(j - 1) <= keys.read(j));
+            jit_assert(keys.read(j) == x.read(values.read(j)));
+        }
+    }
+}
+
+/**
+ * Tests that a weighted histogram computed inside of a frozen function is
+ * recorded and replayed for inputs of different sizes.
+ */
+TEST_LLVM(12_histogram) {
+    using Float32 = typename Float::template ReplaceValue<float>;
+
+    auto func = [](UInt32 x, Float32 w) {
+        return Float32::steal(jit_var_histogram(x.index(), 4, w.index()));
+    };
+
+    FrozenFunction frozen(Backend, func);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        UInt32 x = arange<UInt32>(10 + i) % 5u;
+        Float32 w = full<Float32>(0.5f, 10 + i);
+        make_opaque(x, w);
+
+        Float32 hist = frozen(x, w);
+
+        for (uint32_t j = 0; j < 4; ++j) {
+            uint32_t count = 0;
+            for (uint32_t k = 0; k < 10 + i; ++k)
+                count += (k % 5u) == j;
+            jit_assert(hist.read(j) == 0.5f * count);
+        }
+    }
+}
@@ -1,6 +1,7 @@
 #include "test.h"
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 template <typename Value> inline Value fmix32(Value h) {
     h += 1;
@@ -394,6 +395,100 @@ TEST_BOTH_FLOAT_AGNOSTIC(13_mkperm) {
     }
 }
 
+template <typename Value, typename UInt32>
+void check_sort(uint32_t size, bool with_values) {
+    using Array = typename UInt32::template ReplaceValue<Value>;
+
+    std::unique_ptr<Value[]> keys(new Value[size]);
+    std::unique_ptr<std::pair<Value, uint32_t>[]> ref(new std::pair<Value, uint32_t>[size]);
+    for (uint32_t i = 0; i < size; ++i) {
+        uint64_t r = ((uint64_t) rand() << 32) ^ ((uint64_t) rand() << 8) ^ rand();
+        Value value;
+        if constexpr (std::is_floating_point_v<Value>)
+            value = (Value) ((double) (int64_t) (r % 2001) - 1000.0) * (Value) 0.25;
+        else
+            value = (Value) (r % (size / 2 + 1)) - (Value) (std::is_signed_v<Value> ? size / 4 : 0);
+        keys[i] = value;
+        ref[i] = { value, i };
+    }
+
+    std::stable_sort(ref.get(), ref.get() + size,
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    Array k = Array::steal(jit_var_mem_copy(UInt32::Backend, AllocType::Host,
+                                            Array::Type, keys.get(), size));
+    UInt32 v = arange<UInt32>(size);
+    uint32_t k_out = 0, v_out = 0;
+    jit_var_sort(k.index(), with_values ? v.index() : 0, &k_out,
+                 with_values ? &v_out : nullptr);
+    Array ks = Array::steal(k_out);
+    UInt32 vs = UInt32::steal(v_out);
+
+    for (uint32_t i = 0; i < size; ++i) {
+        jit_assert(ks.read(i) == ref[i].first);
+        if (with_values)
+            jit_assert(vs.read(i) == ref[i].second);
+    }
+}
+
+TEST_LLVM(15_sort) {
+    srand(0);
+    for (uint32_t size : { 1u, 13u, 1000u, 100000u }) {
+        for (int with_values = 0; with_values < 2; ++with_values) {
+            check_sort<uint32_t, UInt32>(size, with_values);
+            check_sort<int32_t, UInt32>(size, with_values);
+            check_sort<float, UInt32>(size, with_values);
+            check_sort<uint64_t, UInt32>(size, with_values);
+            check_sort<int64_t, UInt32>(size, with_values);
+            check_sort<double, UInt32>(size, with_values);
+        }
+    }
+}
+
+TEST_LLVM(16_histogram) {
+    using Float32 = typename UInt32::template ReplaceValue<float>;
+    uint32_t thread_count = jit_llvm_thread_count();
+    srand(0);
+
+    // Several threads exercise the merging of privatized histograms
+    for (uint32_t threads : { 1u, 5u }) {
+        jit_llvm_set_thread_count(threads);
+        for (uint32_t size : { 1u, 13u, 1000u, 100000u }) {
+            for (uint32_t bin_count : { 1u, 7u, 10000u }) {
+                std::unique_ptr<uint32_t[]> values(new uint32_t[size]);
+                std::unique_ptr<float[]> weights(new float[size]);
+                std::vector<uint32_t> ref_count(bin_count, 0);
+                std::vector<double> ref_sum(bin_count, 0.0);
+
+                for (uint32_t i = 0; i < size; ++i) {
+                    // A few entries are out of range and must be skipped
+                    values[i] = (uint32_t) rand() % (bin_count + 2);
+                    weights[i] = (float) (rand() % 8) * 0.25f;
+                    if (values[i] < bin_count) {
+                        ref_count[values[i]]++;
+                        ref_sum[values[i]] += weights[i];
+                    }
+                }
+
+                UInt32 v = UInt32::steal(jit_var_mem_copy(
+                    Backend, AllocType::Host, VarType::UInt32, values.get(), size));
+                Float32 w = Float32::steal(jit_var_mem_copy(
+                    Backend, AllocType::Host, VarType::Float32, weights.get(), size));
+
+                UInt32 count = UInt32::steal(jit_var_histogram(v.index(), bin_count, 0));
+                Float32 sum = Float32::steal(jit_var_histogram(v.index(), bin_count, w.index()));
+
+                for (uint32_t i = 0; i < bin_count; ++i) {
+                    jit_assert(count.read(i) == ref_count[i]);
+                    jit_assert(sum.read(i) == (float) ref_sum[i]);
+                }
+            }
+        }
+    }
+
+    jit_llvm_set_thread_count(thread_count);
+}
+
 #if 0
 TEST_BOTH(14_block_ops) {
     Float a(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f);